@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <set>
 #include <string>
@@ -10,11 +11,24 @@
 #include <cassert>
 #include <optional>
 #include <deque>
+#include <cstdio>
+#include <fstream>
+#include <thread>
 
 #include "Test_Search_Server.h"
 #include "search_server.h"
+#include "concurrent_search_server.h"
+#include "concurrent_map.h"
+#include "network_client.h"
+#include "network_server.h"
+#include "posting_list.h"
+#include "process_queries.h"
+#include "request_queue.h"
+#include "sharded_search_server.h"
+#include "query_executor.h"
 
 using std::string_literals::operator""s;
+using std::string_view_literals::operator""sv;
 
 
 #define ASSERT_EQUAL(a, b) AssertEqualImpl((a), (b), #a, #b, __FILE__, __FUNCTION__, __LINE__, ""s)
@@ -48,6 +62,31 @@ void TestAddDocument() {
     ASSERT(examination.FindTopDocuments("fgh"s).empty());
     ASSERT_EQUAL_HINT(examination.FindTopDocuments("good"s).size(), 1, "Document not added or cannot be found"s);
 }
+void TestAddDocuments() {
+    SearchServer examination("in"s);
+    const std::vector<SearchServer::BatchDocument> documents = {
+        { 0, "good in white dog", DocumentStatus::ACTUAL, { 5,-2 } },
+        { 1, "good black dog", DocumentStatus::BANNED, { 3 } },
+        { 2, "white cat", DocumentStatus::ACTUAL, { 1 } },
+    };
+    examination.AddDocuments(documents);
+    ASSERT_EQUAL(examination.GetDocumentCount(), 3);
+    ASSERT_EQUAL(examination.FindTopDocuments("white"s).size(), 2);
+    ASSERT_EQUAL(examination.FindTopDocuments("dog"s, DocumentStatus::BANNED).size(), 1);
+    ASSERT(examination.FindTopDocuments("in"s).empty());
+    ASSERT_EQUAL(examination.GetWordFrequencies(0).size(), 3);
+
+    const std::vector<SearchServer::BatchDocument> duplicates = { { 3, "cat", DocumentStatus::ACTUAL, { 1 } }, { 2, "dog", DocumentStatus::ACTUAL, { 1 } } };
+    bool is_thrown = false;
+    try {
+        examination.AddDocuments(duplicates);
+    }
+    catch (const std::invalid_argument&) {
+        is_thrown = true;
+    }
+    ASSERT_HINT(is_thrown, "Batch with an existing id must be rejected"s);
+    ASSERT_EQUAL(examination.GetDocumentCount(), 3);
+}
 void TestMinusWords() {
     SearchServer examination;
     DocumentStatus status = DocumentStatus::ACTUAL;
@@ -79,7 +118,7 @@ void TestStopWords() {
     const auto& [checked_document_2_2, id22] = examination2.MatchDocument("good in white a dog"s, 1);
     const auto& [checked_document_3_1, id31] = examination3.MatchDocument("good in white dog"s, 0);
     const auto& [checked_document_3_2, id32] = examination3.MatchDocument("good in white a dog"s, 1);
-    std::vector<std::string> words_doc = { "dog"s,"good"s,"white"s };
+    std::vector<std::string_view> words_doc = { "dog"sv,"good"sv,"white"sv };
 
     ASSERT_EQUAL(checked_document_1, words_doc);
     ASSERT_EQUAL(checked_document_2, words_doc);
@@ -95,8 +134,8 @@ void TestMatchDocument_() {
     examination.AddDocument(0, "good black white dog"s, status, rating);
     const auto& [checked_document1, id1] = examination.MatchDocument(" good  white dog"s, 0);
     const auto& [checked_document2, id2] = examination.MatchDocument("good -white a dog"s, 0);
-    std::vector<std::string> words_doc1 = { "dog"s,"good"s,"white"s };
-    std::vector<std::string> words_doc2 = { };
+    std::vector<std::string_view> words_doc1 = { "dog"sv,"good"sv,"white"sv };
+    std::vector<std::string_view> words_doc2 = { };
     ASSERT_EQUAL(checked_document1, words_doc1);
     ASSERT_EQUAL(checked_document2, words_doc2);
 }
@@ -161,6 +200,785 @@ void TestStatusSorting() {
     ASSERT(examination.FindTopDocuments("1"s, DocumentStatus::BANNED).size() == 1);
     ASSERT(examination.FindTopDocuments("1"s, DocumentStatus::REMOVED).size() == 0);
 }
+void TestTopDocumentsLimit() {
+    SearchServer examination;
+    std::vector<int> rating = { 5,-2 };
+    for (int document_id = 0; document_id < 10; ++document_id) {
+        examination.AddDocument(document_id, "cat dog"s, DocumentStatus::ACTUAL, { document_id });
+    }
+    examination.AddDocument(10, "dog"s, DocumentStatus::ACTUAL, rating);
+    ASSERT_EQUAL(examination.FindTopDocuments("cat"s).size(), MAX_RESULT_DOCUMENT_COUNT);
+    ASSERT_EQUAL(examination.FindTopDocuments("cat"s, DocumentStatus::ACTUAL, 0).size(), 0);
+    const std::vector<Document> top = examination.FindTopDocuments("cat"s, DocumentStatus::ACTUAL, 3);
+    ASSERT_EQUAL(top.size(), 3);
+    ASSERT_EQUAL(top[0].id, 9);
+    ASSERT_EQUAL(top[1].id, 8);
+    ASSERT_EQUAL(top[2].id, 7);
+    ASSERT_EQUAL(examination.FindTopDocuments(std::execution::par, "cat"s, DocumentStatus::ACTUAL, 20).size(), 10);
+}
+void TestCompact() {
+    SearchServer examination("in the"s);
+    std::vector<int> rating = { 5,-2 };
+    examination.AddDocument(0, "cat in the city"s, DocumentStatus::ACTUAL, rating);
+    examination.AddDocument(1, "dog in the park"s, DocumentStatus::ACTUAL, rating);
+    examination.AddDocument(2, "cat and dog"s, DocumentStatus::ACTUAL, rating);
+    examination.RemoveDocument(1);
+    examination.Compact();
+    ASSERT(examination.FindTopDocuments("park"s).empty());
+    ASSERT_EQUAL(examination.FindTopDocuments("dog"s).size(), 1);
+    ASSERT_EQUAL(examination.FindTopDocuments("cat in"s).size(), 2);
+    ASSERT_EQUAL(examination.GetWordFrequencies(0).size(), 2);
+    ASSERT_EQUAL(examination.GetWordFrequencies(0).count("city"), 1);
+    const auto [words, status] = examination.MatchDocument("cat dog -city"s, 2);
+    ASSERT_EQUAL(words.size(), 2);
+}
+void TestTombstones() {
+    SearchServer examination("in the"s);
+    for (int document_id = 0; document_id < 100; ++document_id) {
+        examination.AddDocument(document_id, document_id % 2 == 0 ? "cat in the city"s : "dog in the city"s, DocumentStatus::ACTUAL, { document_id });
+    }
+    for (int document_id = 0; document_id < 100; document_id += 2) {
+        examination.RemoveDocument(document_id);
+    }
+    // Removed documents are skipped before and after their postings are purged
+    for (int pass = 0; pass < 2; ++pass) {
+        ASSERT(examination.FindTopDocuments("cat"s).empty());
+        ASSERT(examination.FindTopDocuments(std::execution::par, "cat"s).empty());
+        ASSERT_EQUAL(examination.FindTopDocuments("city"s, DocumentStatus::ACTUAL, 100).size(), 50);
+        ASSERT_EQUAL(examination.FindTopDocuments("city dog"s)[0].rating, 99);
+        examination.Compact();
+    }
+    // Compact drops the attributes of removed documents too
+    ASSERT_EQUAL(examination.GetOrdinalCount(), 50);
+    examination.AddDocument(0, "cat"s, DocumentStatus::ACTUAL, { 1 });
+    ASSERT_EQUAL(examination.FindTopDocuments("cat"s).size(), 1);
+    ASSERT_EQUAL(examination.GetOrdinalCount(), 51);
+}
+void TestCompactRenumbersOrdinals() {
+    // Churn over several sealed segments, one of which loses every document
+    const std::vector<std::string> words = { "cat"s, "dog"s, "city"s, "park"s, "old"s, "fluffy"s };
+    std::vector<std::string> texts;
+    for (int document_id = 0; document_id < 20000; ++document_id) {
+        texts.push_back(words[document_id % words.size()] + " "s + words[document_id / 7 % words.size()]);
+    }
+    const auto is_removed = [](int document_id) {
+        return (document_id >= 4096 && document_id < 9000) || document_id % 3 == 0;
+    };
+    for (const bool impact_ordered : { false, true }) {
+        SearchServer churned("in the"s);
+        SearchServer expected("in the"s);
+        churned.SetImpactOrdered(impact_ordered);
+        for (int document_id = 0; document_id < 20000; ++document_id) {
+            const DocumentStatus status = document_id % 5 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL;
+            churned.AddDocument(document_id, texts[document_id], status, { document_id % 11 });
+            if (!is_removed(document_id)) {
+                expected.AddDocument(document_id, texts[document_id], status, { document_id % 11 });
+            }
+        }
+        for (int document_id = 0; document_id < 20000; ++document_id) {
+            if (is_removed(document_id)) {
+                churned.RemoveDocument(document_id);
+            }
+        }
+        churned.Compact();
+        ASSERT_EQUAL(churned.GetOrdinalCount(), expected.GetDocumentCount());
+        for (const std::string& query : { "cat"s, "dog -city"s, "fluffy old"s, "+park cat"s }) {
+            for (const DocumentStatus status : { DocumentStatus::ACTUAL, DocumentStatus::BANNED }) {
+                // Pruned top-K search finds equally relevant documents
+                const std::vector<Document> top = churned.FindTopDocuments(query, status, 50);
+                const std::vector<Document> wanted_top = expected.FindTopDocuments(query, status, 50);
+                ASSERT_EQUAL(top.size(), wanted_top.size());
+                for (size_t i = 0; i < top.size(); ++i) {
+                    ASSERT(std::abs(top[i].relevance - wanted_top[i].relevance) < 1e-6);
+                }
+                // Many documents tie, so whole results are compared by id
+                std::vector<Document> actual = churned.FindTopDocuments(query, status, 20000);
+                std::vector<Document> wanted = expected.FindTopDocuments(query, status, 20000);
+                ASSERT_EQUAL(actual.size(), wanted.size());
+                const auto by_id = [](const Document& lhs, const Document& rhs) { return lhs.id < rhs.id; };
+                std::sort(actual.begin(), actual.end(), by_id);
+                std::sort(wanted.begin(), wanted.end(), by_id);
+                for (size_t i = 0; i < actual.size(); ++i) {
+                    ASSERT_EQUAL(actual[i].id, wanted[i].id);
+                    ASSERT(std::abs(actual[i].relevance - wanted[i].relevance) < 1e-6);
+                }
+            }
+        }
+        ASSERT(churned.MatchDocument("cat dog"s, 20000 - 1) == expected.MatchDocument("cat dog"s, 20000 - 1));
+        // New documents and removals keep working on the renumbered index
+        churned.AddDocument(3, "fluffy"s, DocumentStatus::ACTUAL, { 100 });
+        churned.RemoveDocument(1);
+        ASSERT_EQUAL(churned.FindTopDocuments("fluffy"s)[0].rating, 100);
+        ASSERT(churned.GetWordFrequencies(1).empty());
+        ASSERT_EQUAL(churned.GetWordFrequencies(2).size(), 2);
+    }
+}
+void TestSnapshot() {
+    const std::string path = "search_server_snapshot.tmp"s;
+    {
+        SearchServer examination("in the"s);
+        examination.AddDocument(0, "cat in the city"s, DocumentStatus::ACTUAL, { 5,-2 });
+        examination.AddDocument(1, "dog in the park"s, DocumentStatus::BANNED, { 7 });
+        examination.AddDocument(2, "cat and dog"s, DocumentStatus::ACTUAL, { 1 });
+        examination.RemoveDocument(0);
+        examination.SaveSnapshot(path);
+    }
+    SearchServer restored = SearchServer::OpenSnapshot(path);
+    ASSERT_EQUAL(restored.GetDocumentCount(), 2);
+    ASSERT(restored.FindTopDocuments("city"s).empty());
+    ASSERT(restored.FindTopDocuments("the"s).empty());
+    ASSERT_EQUAL(restored.FindTopDocuments("dog"s, DocumentStatus::BANNED)[0].rating, 7);
+    ASSERT_EQUAL(restored.GetWordFrequencies(2).size(), 3);
+    restored.AddDocument(3, "cat"s, DocumentStatus::ACTUAL, { 2 });
+    ASSERT_EQUAL(restored.FindTopDocuments("cat"s).size(), 2);
+
+    // Saving over the mapped file replaces it without touching the mapping
+    restored.SaveSnapshot(path);
+    ASSERT_EQUAL(std::get<0>(restored.MatchDocument("cat dog"s, 2)).size(), 2);
+    ASSERT_EQUAL(SearchServer::OpenSnapshot(path).FindTopDocuments("cat"s).size(), 2);
+
+    // Term offsets going backwards would describe text outside the file
+    {
+        std::ofstream corrupt(path, std::ios::binary | std::ios::trunc);
+        const uint32_t header[2] = { SNAPSHOT_VERSION, 0 };
+        const uint64_t terms[4] = { 2, 0, 5, 3 };
+        corrupt.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        corrupt.write(reinterpret_cast<const char*>(header), sizeof(header));
+        corrupt.write(reinterpret_cast<const char*>(terms), sizeof(terms));
+        corrupt.write("catdog\0\0", 8);
+    }
+    const auto is_rejected = [&path]() {
+        try {
+            SearchServer::OpenSnapshot(path);
+        }
+        catch (const std::invalid_argument&) {
+            return true;
+        }
+        return false;
+    };
+    ASSERT_HINT(is_rejected(), "Corrupt snapshot must be rejected"s);
+
+    // Snapshots without terms holding two documents with these attributes
+    const auto write_documents = [&path](const std::vector<int>& document_ids, const std::vector<int32_t>& statuses, const std::vector<int>& lengths) {
+        SnapshotWriter writer(path);
+        writer.WriteArray(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        writer.Write(SNAPSHOT_VERSION);
+        writer.Write(uint32_t(0));
+        const uint64_t no_offsets[1] = { 0 };
+        writer.Write(uint64_t(0));
+        writer.WriteArray(no_offsets, 1);
+        writer.WriteArray(no_offsets, 1);
+        const uint64_t document_count = 2;
+        const int ratings[2] = { 1, 2 };
+        const uint8_t live[2] = { 1, 1 };
+        const uint64_t forward_offsets[3] = { 0, 0, 0 };
+        writer.Write(document_count);
+        writer.WriteArray(document_ids.data(), document_count);
+        writer.WriteArray(ratings, document_count);
+        writer.WriteArray(statuses.data(), document_count);
+        writer.WriteArray(live, document_count);
+        writer.WriteArray(lengths.data(), document_count);
+        writer.WriteArray(forward_offsets, document_count + 1);
+        writer.Finish();
+    };
+    write_documents({ 0, 1 }, { 0, 1 }, { 3, 4 });
+    ASSERT_EQUAL(SearchServer::OpenSnapshot(path).GetDocumentCount(), 2);
+    write_documents({ 0, 1 }, { 0, 7 }, { 3, 4 });
+    ASSERT_HINT(is_rejected(), "Snapshot with an unknown status must be rejected"s);
+    write_documents({ 0, 0 }, { 0, 1 }, { 3, 4 });
+    ASSERT_HINT(is_rejected(), "Snapshot with a duplicate live document must be rejected"s);
+    write_documents({ 0, 1 }, { 0, 1 }, { 3, -4 });
+    ASSERT_HINT(is_rejected(), "Snapshot with a negative document length must be rejected"s);
+    std::remove(path.c_str());
+}
+void TestSegments() {
+    // Enough documents to seal several segments and merge some of them
+    SearchServer examination("in the"s);
+    const int document_count = 20000;
+    for (int document_id = 0; document_id < document_count; ++document_id) {
+        const std::string text = document_id % 1000 == 0 ? "cat in the city"s : "dog in the park"s;
+        examination.AddDocument(document_id, text, DocumentStatus::ACTUAL, { document_id % 10 });
+    }
+    for (int document_id = 0; document_id < document_count; document_id += 2000) {
+        examination.RemoveDocument(document_id);
+    }
+    ASSERT_EQUAL(examination.GetDocumentCount(), document_count - 10);
+    ASSERT_EQUAL(examination.FindTopDocuments("cat"s, DocumentStatus::ACTUAL, 100).size(), 10);
+    ASSERT_EQUAL(examination.FindTopDocuments(std::execution::par, "cat"s, DocumentStatus::ACTUAL, 100).size(), 10);
+    ASSERT(examination.FindTopDocuments("dog -park"s).empty());
+    const auto [words, status] = examination.MatchDocument("cat city -park"s, 19000);
+    ASSERT_EQUAL(words.size(), 2);
+}
+void TestPostingListCompression() {
+    // Gaps of every width, up to one spanning most of the id range
+    PostingList plain;
+    std::vector<int> document_ids;
+    int document_id = 0;
+    for (int i = 0; i < 1000; ++i) {
+        document_id += i == 500 ? 100000000 : 1 + (i * 7919) % (1 << (i % 17));
+        document_ids.push_back(document_id);
+        plain.Add(document_id, i % 3 == 0 ? 1.0 / (i + 1) : 0.25);
+    }
+    PostingList compressed = plain;
+    compressed.Compress();
+    ASSERT(compressed.IsCompressed());
+    ASSERT_EQUAL(compressed.size(), plain.size());
+    ASSERT(compressed.GetMemoryUsage() < plain.GetMemoryUsage() / 2);
+    ASSERT(std::equal(compressed.begin(), compressed.end(), plain.begin(), plain.end()));
+    std::vector<int> buffer;
+    ASSERT(compressed.ReadDocumentIds(buffer) == document_ids);
+
+    for (const int probe : { -1, 0, 5, document_ids[127], document_ids[128] - 1, document_ids[500] - 1, document_ids[999], document_ids[999] + 1 }) {
+        PostingList::Cursor cursor(compressed, 3);
+        cursor.Seek(probe);
+        const size_t position = std::max<size_t>(3, std::lower_bound(document_ids.begin(), document_ids.end(), probe) - document_ids.begin());
+        ASSERT_EQUAL(cursor.GetPosition(), position);
+        ASSERT_EQUAL(cursor.IsAtEnd(), position == document_ids.size());
+        if (!cursor.IsAtEnd()) {
+            ASSERT_EQUAL(cursor.GetDocumentId(), document_ids[position]);
+            ASSERT_EQUAL(cursor.GetTermFreq(), plain.GetTermFreq(document_ids[position]));
+        }
+        ASSERT_EQUAL(compressed.Contains(probe), plain.Contains(probe));
+        ASSERT_EQUAL(compressed.GetTermFreq(probe), plain.GetTermFreq(probe));
+    }
+
+    // Changes go to the decompressed list
+    compressed.Add(document_ids[10] + 1, 2.0);
+    plain.Add(document_ids[10] + 1, 2.0);
+    ASSERT(!compressed.IsCompressed());
+    ASSERT(std::equal(compressed.begin(), compressed.end(), plain.begin(), plain.end()));
+
+    PostingList short_list;
+    short_list.Add(1, 1.0);
+    short_list.Compress();
+    ASSERT(!short_list.IsCompressed());
+}
+void TestConcurrentSearchServer() {
+    ConcurrentSearchServer examination("in the"s);
+    const int document_count = 2000;
+    std::thread writer([&examination, document_count]() {
+        for (int document_id = 0; document_id < document_count; ++document_id) {
+            examination.AddDocument(document_id, "cat in the city"s, DocumentStatus::ACTUAL, { 1 });
+            if (document_id % 2 == 1) {
+                examination.RemoveDocument(document_id - 1);
+            }
+        }
+    });
+    // Within one version the postings always agree with the document set
+    while (examination.GetVersion() < document_count * 3 / 2) {
+        const bool is_consistent = examination.Read([document_count](const SearchServer& search_server) {
+            return static_cast<int>(search_server.FindTopDocuments("cat"s, DocumentStatus::ACTUAL, document_count).size()) == search_server.GetDocumentCount();
+        });
+        ASSERT(is_consistent);
+    }
+    writer.join();
+    ASSERT_EQUAL(examination.GetDocumentCount(), document_count / 2);
+    ASSERT_EQUAL(examination.FindTopDocuments("city"s, DocumentStatus::ACTUAL, document_count).size(), document_count / 2);
+    ASSERT_EQUAL(examination.GetVersion(), document_count * 3 / 2);
+
+    // Matched words are owned by the caller and survive later updates
+    const auto [words, status] = examination.MatchDocument("cat city dog"s, document_count - 1);
+    examination.RemoveDocument(document_count - 1);
+    examination.Compact();
+    ASSERT_EQUAL(words, std::vector<std::string>({ "cat"s, "city"s }));
+}
+void TestConcurrentMap() {
+    ConcurrentMap<int, double> relevance(1000);
+    std::vector<int> keys(10000);
+    for (int i = 0; i < static_cast<int>(keys.size()); ++i) {
+        keys[i] = i % 1000;
+    }
+    std::for_each(std::execution::par, keys.begin(), keys.end(), [&relevance](int key) {
+        relevance.Add(key, 0.5);
+        if (key % 10 == 0) {
+            relevance.erase(key);
+        }
+    });
+    const std::vector<std::pair<int, double>> result = relevance.BuildSortedVector();
+    ASSERT_EQUAL(result.size(), 900);
+    ASSERT_EQUAL(result.front().first, 1);
+    ASSERT(std::is_sorted(result.begin(), result.end()));
+    ASSERT(std::all_of(result.begin(), result.end(), [](const std::pair<int, double>& entry) { return entry.second == 5.0; }));
+}
+void TestQueryExecutor() {
+    QueryExecutor executor(2);
+    std::vector<int> sums(100, 0);
+    // Nested loops share the workers with the outer one
+    executor.ParallelFor(sums.size(), [&executor, &sums](size_t i) {
+        std::vector<int> parts(10, 0);
+        executor.ParallelFor(parts.size(), [&parts, i](size_t j) {
+            parts[j] = static_cast<int>(i * j);
+        });
+        for (const int part : parts) {
+            sums[i] += part;
+        }
+    });
+    for (size_t i = 0; i < sums.size(); ++i) {
+        ASSERT_EQUAL(sums[i], static_cast<int>(i) * 45);
+    }
+    bool thrown = false;
+    try {
+        executor.ParallelFor(10, [](size_t i) {
+            if (i == 7) {
+                throw std::invalid_argument("task failed"s);
+            }
+        });
+    }
+    catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+
+    SearchServer examination("in the"s);
+    examination.AddDocument(0, "cat in the city"s, DocumentStatus::ACTUAL, { 1 });
+    examination.AddDocument(1, "dog in the park"s, DocumentStatus::ACTUAL, { 2 });
+    const std::vector<std::vector<Document>> results = ProcessQueries(executor, examination, { "cat"s, "dog park"s, "bird"s });
+    ASSERT_EQUAL(results.size(), 3);
+    ASSERT_EQUAL(results[0][0].id, 0);
+    ASSERT_EQUAL(results[1][0].id, 1);
+    ASSERT(results[2].empty());
+}
+void TestQueryCache() {
+    SearchServer examination("in the"s);
+    examination.AddDocument(0, "cat in the city"s, DocumentStatus::ACTUAL, { 1 });
+    examination.AddDocument(1, "dog in the park"s, DocumentStatus::ACTUAL, { 2 });
+    ASSERT_EQUAL(examination.FindTopDocuments("cat"s)[0].id, 0);
+    // The same query with repeated and reordered words hits the cache
+    ASSERT_EQUAL(examination.FindTopDocuments("cat cat -park"s).size(), 1);
+    ASSERT_EQUAL(examination.FindTopDocuments("-park cat"s)[0].id, 0);
+    ASSERT_EQUAL(examination.GetQueryCacheStats().hit_count, 1);
+    ASSERT_EQUAL(examination.GetQueryCacheStats().miss_count, 2);
+    // Other statuses and limits are cached separately
+    ASSERT(examination.FindTopDocuments("cat"s, DocumentStatus::BANNED).empty());
+    ASSERT_EQUAL(examination.GetQueryCacheStats().miss_count, 3);
+    // Updates invalidate every cached result
+    examination.AddDocument(2, "cat in the park"s, DocumentStatus::ACTUAL, { 3 });
+    ASSERT_EQUAL(examination.FindTopDocuments("cat"s).size(), 2);
+    examination.RemoveDocument(0);
+    ASSERT_EQUAL(examination.FindTopDocuments("cat"s).size(), 1);
+    examination.Compact();
+    ASSERT_EQUAL(examination.FindTopDocuments("cat"s)[0].id, 2);
+    ASSERT_EQUAL(examination.GetQueryCacheStats().hit_count, 1);
+}
+void TestPreparedQuery() {
+    SearchServer examination("in the"s);
+    examination.AddDocument(0, "cat in the city"s, DocumentStatus::ACTUAL, { 1 });
+    examination.AddDocument(1, "dog in the park"s, DocumentStatus::ACTUAL, { 2 });
+    examination.AddDocument(2, "old cat in the park"s, DocumentStatus::BANNED, { 3 });
+    const SearchServer::PreparedQuery query = examination.PrepareQuery("cat bird -park"s);
+    for (int run = 0; run < 2; ++run) {
+        ASSERT_EQUAL(examination.FindTopDocuments(query).size(), 1);
+        ASSERT_EQUAL(examination.FindTopDocuments(std::execution::par, query)[0].id, 0);
+    }
+    ASSERT(examination.FindTopDocuments(query, DocumentStatus::BANNED).empty());
+    ASSERT_EQUAL(examination.FindTopDocuments(query, [](int document_id, DocumentStatus status, int rating) { return rating > 0; }).size(), 1);
+    // Parallel matching follows the same path as the sequential one
+    const SearchServer::PreparedQuery match_query = examination.PrepareQuery("park cat dog cat"s);
+    ASSERT(examination.MatchDocument(std::execution::par, match_query, 2) == examination.MatchDocument(match_query, 2));
+    ASSERT(examination.MatchDocument(std::execution::par, "park cat dog cat"s, 2) == examination.MatchDocument("park cat dog cat"s, 2));
+    ASSERT_EQUAL(std::get<0>(examination.MatchDocument(match_query, 2)).size(), 2);
+    // A word unknown at preparation time is found once a document adds it
+    examination.AddDocument(3, "bird in the city"s, DocumentStatus::ACTUAL, { 4 });
+    ASSERT_EQUAL(examination.FindTopDocuments(query).size(), 2);
+    // Compact renumbers terms; the prepared query is resolved again
+    examination.RemoveDocument(1);
+    examination.Compact();
+    ASSERT_EQUAL(examination.FindTopDocuments(query).size(), 2);
+    ASSERT_EQUAL(ProcessQueries(examination, { query, match_query })[1].size(), 1);
+    RequestQueue request_queue(examination);
+    ASSERT_EQUAL(request_queue.AddFindRequest(query).size(), 2);
+    ASSERT_EQUAL(request_queue.GetNoResultRequests(), 0);
+    // Idfs given by the caller are attached to the terms already resolved
+    SearchServer::PreparedQuery weighted_query = examination.PrepareQuery("cat bird"s);
+    weighted_query.SetInverseDocumentFreqs({ 4.0, 1.0 });
+    const std::vector<Document> weighted_documents = examination.FindTopDocuments(weighted_query);
+    ASSERT_EQUAL(weighted_documents[0].id, 3);
+    ASSERT(std::abs(weighted_documents[0].relevance - 2.0) < 1e-6);
+    bool is_thrown = false;
+    try {
+        examination.PrepareQuery("cat --dog"s);
+    }
+    catch (const std::invalid_argument&) {
+        is_thrown = true;
+    }
+    ASSERT_HINT(is_thrown, "Invalid query must be rejected when it is prepared"s);
+}
+void TestShardedSearchServer() {
+    const std::vector<std::string> words = { "cat"s, "dog"s, "city"s, "park"s, "old"s, "fluffy"s, "tail"s };
+    SearchServer single("in the"s);
+    ShardedSearchServer sharded("in the"s, 4);
+    std::vector<SearchServer::BatchDocument> batch;
+    std::vector<std::string> texts;
+    for (int document_id = 0; document_id < 200; ++document_id) {
+        texts.push_back(words[document_id % 7] + " in the "s + words[document_id % 5] + " "s + words[document_id % 3]);
+    }
+    for (int document_id = 0; document_id < 200; ++document_id) {
+        const DocumentStatus status = document_id % 10 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL;
+        single.AddDocument(document_id, texts[document_id], status, { document_id });
+        if (document_id < 100) {
+            sharded.AddDocument(document_id, texts[document_id], status, { document_id });
+        }
+        else {
+            batch.push_back({ document_id, texts[document_id], status, { document_id } });
+        }
+    }
+    sharded.AddDocuments(batch);
+    ASSERT_EQUAL(sharded.GetDocumentCount(), 200);
+    // Idf over all shards ranks documents as one server holding them all does
+    for (int pass = 0; pass < 2; ++pass) {
+        for (const std::string& query : { "cat"s, "fluffy dog -park"s, "old tail city"s }) {
+            const std::vector<Document> expected = single.FindTopDocuments(query, DocumentStatus::ACTUAL, 20);
+            const std::vector<Document> actual = sharded.FindTopDocuments(query, DocumentStatus::ACTUAL, 20);
+            ASSERT_EQUAL(actual.size(), expected.size());
+            for (size_t i = 0; i < actual.size(); ++i) {
+                ASSERT(std::abs(actual[i].relevance - expected[i].relevance) < 1e-9);
+                ASSERT_EQUAL(actual[i].rating, expected[i].rating);
+            }
+        }
+        for (int document_id = 1; document_id < 200; document_id += 4) {
+            single.RemoveDocument(document_id);
+            sharded.RemoveDocument(document_id);
+        }
+        sharded.Compact();
+    }
+    ASSERT(sharded.MatchDocument("cat city"s, 0) == single.MatchDocument("cat city"s, 0));
+    ASSERT(sharded.FindTopDocuments("cat"s, [](int document_id, DocumentStatus status, int rating) { return document_id == 7; })[0].id == 7);
+    // A batch rejected by one shard leaves every shard unchanged
+    bool is_thrown = false;
+    try {
+        sharded.AddDocuments({ { 1000, "cat", DocumentStatus::ACTUAL, { 1 } }, { 1001, "d\x12og", DocumentStatus::ACTUAL, { 1 } } });
+    }
+    catch (const std::invalid_argument&) {
+        is_thrown = true;
+    }
+    ASSERT_HINT(is_thrown, "Batch with an invalid document must be rejected"s);
+    ASSERT_EQUAL(sharded.GetDocumentCount(), single.GetDocumentCount());
+}
+void TestNetworkServer() {
+    const std::string socket_path = "search_server_test.sock"s;
+    SearchServer examination("in the"s);
+    NetworkServer network_server(examination, 2);
+    const uint16_t port = network_server.ListenTcp("127.0.0.1"s, 0);
+    network_server.ListenUnix(socket_path);
+    std::thread serving([&network_server]() { network_server.Run(); });
+
+    NetworkClient client = NetworkClient::ConnectTcp("127.0.0.1"s, port);
+    client.AddDocument(0, "cat in the city"s, DocumentStatus::ACTUAL, { 5, -2 });
+    client.AddDocument(1, "dog in the park"s, DocumentStatus::BANNED, { 7 });
+    ASSERT_EQUAL(client.FindTopDocuments("cat"s)[0].id, 0);
+    ASSERT_EQUAL(client.FindTopDocuments("dog"s, DocumentStatus::BANNED)[0].rating, 7);
+    const auto [words, status] = client.MatchDocument("park dog -cat"s, 1);
+    ASSERT_EQUAL(words.size(), 2);
+    ASSERT_EQUAL(static_cast<int>(status), static_cast<int>(DocumentStatus::BANNED));
+
+    // Pipelined requests are answered in order, errors only fail their own request
+    NetworkClient pipelined = NetworkClient::ConnectUnix(socket_path);
+    const std::string bird_query = "bird"s;
+    const std::string invalid_query = "cat --dog"s;
+    std::vector<std::string> texts;
+    for (int document_id = 2; document_id < 200; ++document_id) {
+        texts.push_back("bird number "s + std::to_string(document_id));
+    }
+    for (int document_id = 2; document_id < 200; ++document_id) {
+        Request request;
+        request.type = RequestType::ADD_DOCUMENT;
+        request.document_id = document_id;
+        request.text = texts[document_id - 2];
+        request.ratings = { document_id };
+        pipelined.Send(request);
+        request.type = RequestType::FIND_TOP_DOCUMENTS;
+        request.text = bird_query;
+        request.top_k = 1000;
+        pipelined.Send(request);
+    }
+    Request invalid;
+    invalid.text = invalid_query;
+    pipelined.Send(invalid);
+    Request remove;
+    remove.type = RequestType::REMOVE_DOCUMENT;
+    remove.document_id = 0;
+    const uint32_t remove_id = pipelined.Send(remove);
+    for (int document_id = 2; document_id < 200; ++document_id) {
+        ASSERT(pipelined.Receive().is_ok);
+        ASSERT_EQUAL(pipelined.Receive().documents.size(), document_id - 1);
+    }
+    ASSERT(!pipelined.Receive().is_ok);
+    ASSERT_EQUAL(pipelined.Receive().request_id, remove_id);
+    ASSERT(client.FindTopDocuments("cat"s).empty());
+
+    bool is_thrown = false;
+    try {
+        client.MatchDocument("cat"s, 1000);
+    }
+    catch (const std::runtime_error&) {
+        is_thrown = true;
+    }
+    ASSERT_HINT(is_thrown, "Server errors must reach the client"s);
+
+    // A frame larger than a usual read batch still completes
+    const std::string huge_word(5 << 20, 'x');
+    client.AddDocument(1000, "giant "s + huge_word, DocumentStatus::ACTUAL, { 1 });
+    ASSERT_EQUAL(client.FindTopDocuments("giant"s)[0].id, 1000);
+    ASSERT_EQUAL(std::get<0>(client.MatchDocument(huge_word, 1000)).front().size(), huge_word.size());
+    network_server.Stop();
+    serving.join();
+}
+void TestImpactOrderedPostings() {
+    const std::vector<std::string> words = { "cat"s, "dog"s, "city"s, "park"s, "old"s, "fluffy"s, "tail"s, "collar"s, "street"s };
+    SearchServer document_ordered("in the"s);
+    SearchServer impact_ordered("in the"s);
+    impact_ordered.SetImpactOrdered(true);
+    std::vector<std::string> texts;
+    for (int document_id = 0; document_id < 10000; ++document_id) {
+        std::string text = "in the"s;
+        for (int word = 0; word < 1 + document_id % 6; ++word) {
+            text += " "s + words[(document_id / (word + 1) + word * 5) % words.size()];
+        }
+        texts.push_back(text);
+    }
+    std::vector<SearchServer::BatchDocument> batch;
+    for (int document_id = 0; document_id < 10000; ++document_id) {
+        const DocumentStatus status = document_id % 7 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL;
+        batch.push_back({ document_id, texts[document_id], status, { document_id } });
+    }
+    document_ordered.AddDocuments(batch);
+    impact_ordered.AddDocuments(batch);
+    const auto assert_same_results = [](const std::vector<Document>& actual, const std::vector<Document>& expected) {
+        ASSERT_EQUAL(actual.size(), expected.size());
+        for (size_t i = 0; i < actual.size(); ++i) {
+            ASSERT_EQUAL(actual[i].id, expected[i].id);
+            ASSERT(std::abs(actual[i].relevance - expected[i].relevance) < 1e-9);
+        }
+    };
+    for (int pass = 0; pass < 2; ++pass) {
+        for (const std::string& query : { "cat"s, "fluffy dog -park"s, "old tail city collar"s, "street -cat -dog"s }) {
+            for (const size_t top_k : { 1, 5, 50 }) {
+                assert_same_results(impact_ordered.FindTopDocuments(query, DocumentStatus::ACTUAL, top_k),
+                    document_ordered.FindTopDocuments(query, DocumentStatus::ACTUAL, top_k));
+            }
+            const auto is_even = [](int document_id, DocumentStatus status, int rating) { return document_id % 2 == 0; };
+            assert_same_results(impact_ordered.FindTopDocuments(query, is_even), document_ordered.FindTopDocuments(query, is_even));
+        }
+        for (int document_id = 1; document_id < 10000; document_id += 3) {
+            document_ordered.RemoveDocument(document_id);
+            impact_ordered.RemoveDocument(document_id);
+        }
+        if (pass == 0) {
+            impact_ordered.Compact();
+        }
+    }
+    impact_ordered.SetImpactOrdered(false);
+    assert_same_results(impact_ordered.FindTopDocuments("fluffy dog -park"s), document_ordered.FindTopDocuments("fluffy dog -park"s));
+
+    // Score bounds assume non-negative contributions, so negative idfs are refused
+    SearchServer::PreparedQuery prepared_query = impact_ordered.PrepareQuery("fluffy dog"s);
+    bool is_thrown = false;
+    try {
+        prepared_query.SetInverseDocumentFreqs({ 1.0, -0.5 });
+    }
+    catch (const std::invalid_argument&) {
+        is_thrown = true;
+    }
+    ASSERT_HINT(is_thrown, "Negative idf must be rejected"s);
+}
+void TestFiltersAndScoringPolicies() {
+    SearchServer examination("in the"s);
+    examination.AddDocument(0, "cat in the city"s, DocumentStatus::ACTUAL, { 1 });
+    examination.AddDocument(1, "cat cat dog park"s, DocumentStatus::ACTUAL, { 5 });
+    examination.AddDocument(2, "cat and a fluffy dog"s, DocumentStatus::BANNED, { 9 });
+    examination.AddDocument(3, "old dog"s, DocumentStatus::ACTUAL, { 3 });
+    examination.AddDocument(4, "cat"s, DocumentStatus::IRRELEVANT, { 7 });
+    QueryExecutor executor(2);
+    const auto same_results = [](const std::vector<Document>& lhs, const std::vector<Document>& rhs) {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+            [](const Document& lhs_document, const Document& rhs_document) {
+                return lhs_document.id == rhs_document.id && std::abs(lhs_document.relevance - rhs_document.relevance) < 1e-9
+                    && lhs_document.rating == rhs_document.rating;
+            });
+    };
+    for (int pass = 0; pass < 2; ++pass) {
+        // Recognized filters select the same documents as equivalent lambdas
+        const auto is_banned = [](int document_id, DocumentStatus status, int rating) { return status == DocumentStatus::BANNED; };
+        const auto is_rated = [](int document_id, DocumentStatus status, int rating) { return rating >= 3 && rating <= 7; };
+        for (const std::string& query : { "cat"s, "dog -park"s, "cat dog city"s }) {
+            ASSERT(same_results(examination.FindTopDocuments(query, StatusFilter{ DocumentStatus::BANNED }), examination.FindTopDocuments(query, is_banned)));
+            ASSERT(same_results(examination.FindTopDocuments(query, RatingRange{ 3, 7 }), examination.FindTopDocuments(query, is_rated)));
+            ASSERT(same_results(examination.FindTopDocuments(std::execution::par, query, RatingRange{ 3, 7 }), examination.FindTopDocuments(query, is_rated)));
+            ASSERT(same_results(examination.FindTopDocuments(executor, query, RatingRange{ 3, 7 }), examination.FindTopDocuments(query, is_rated)));
+        }
+        examination.RemoveDocument(4);
+    }
+    ASSERT(examination.FindTopDocuments("cat"s, StatusFilter{ DocumentStatus::IRRELEVANT }).empty());
+    ASSERT(same_results(examination.FindTopDocumentsScored(TfIdfScoring(), "cat dog"s), examination.FindTopDocuments("cat dog"s)));
+
+    // BM25 over the four remaining documents, 13 words in all, three of them with "cat"
+    const std::vector<Document> found_documents = examination.FindTopDocumentsScored(Bm25Scoring(1.2, 0.75), "cat"s);
+    ASSERT_EQUAL(found_documents.size(), 2);
+    const double cat_weight = std::log(1.0 + (4 - 3 + 0.5) / (3 + 0.5));
+    const double average_length = 13.0 / 4;
+    ASSERT_EQUAL(found_documents[0].id, 1);
+    ASSERT(std::abs(found_documents[0].relevance - cat_weight * 2 * 2.2 / (2 + 1.2 * (0.25 + 0.75 * 4 / average_length))) < 1e-9);
+    ASSERT_EQUAL(found_documents[1].id, 0);
+    ASSERT(std::abs(found_documents[1].relevance - cat_weight * 2.2 / (1 + 1.2 * (0.25 + 0.75 * 2 / average_length))) < 1e-9);
+    ASSERT(examination.FindTopDocumentsScored(Bm25Scoring(), "cat dog"s, DocumentStatus::ACTUAL, 1)[0].id == 1);
+
+    examination.SaveSnapshot("scoring_snapshot.bin"s);
+    const SearchServer reopened = SearchServer::OpenSnapshot("scoring_snapshot.bin"s);
+    ASSERT(same_results(reopened.FindTopDocumentsScored(Bm25Scoring(1.2, 0.75), "cat"s), found_documents));
+    std::remove("scoring_snapshot.bin");
+
+    // Pruned BM25 top-K agrees with ranking every match
+    const std::vector<std::string> words = { "cat"s, "dog"s, "city"s, "park"s, "old"s, "fluffy"s, "tail"s };
+    SearchServer larger;
+    for (int document_id = 0; document_id < 300; ++document_id) {
+        std::string text;
+        for (int word = 0; word < 1 + document_id % 9; ++word) {
+            text += words[(document_id * 7 + word * word) % words.size()] + " "s;
+        }
+        larger.AddDocument(document_id, text, DocumentStatus::ACTUAL, { document_id });
+    }
+    for (const std::string& query : { "cat"s, "fluffy dog -park"s, "old tail city"s }) {
+        std::vector<Document> all_documents = larger.FindTopDocumentsScored(Bm25Scoring(), query, DocumentStatus::ACTUAL, 300);
+        all_documents.resize(std::min<size_t>(all_documents.size(), 5));
+        ASSERT(same_results(larger.FindTopDocumentsScored(Bm25Scoring(), query), all_documents));
+    }
+}
+void TestMinusWordsExcludeEverywhere() {
+    // Enough documents for sealed segments next to the mutable one, and a
+    // minus word common to every third of them
+    SearchServer examination;
+    std::vector<std::string> texts;
+    for (int document_id = 0; document_id < 6000; ++document_id) {
+        texts.push_back((document_id % 3 == 0 ? "noise "s : ""s) + (document_id % 2 == 0 ? "cat city"s : "cat dog park"s));
+    }
+    for (int document_id = 0; document_id < 6000; ++document_id) {
+        examination.AddDocument(document_id, texts[document_id], DocumentStatus::ACTUAL, { document_id });
+    }
+    QueryExecutor executor(2);
+    const auto check_results = [](const std::vector<Document>& documents, size_t expected_count) {
+        ASSERT_EQUAL(documents.size(), expected_count);
+        for (const Document& document : documents) {
+            ASSERT_HINT(document.id % 3 != 0, "Documents with minus words must be excluded"s);
+        }
+    };
+    check_results(examination.FindTopDocuments("cat -noise"s), 5);
+    check_results(examination.FindTopDocuments("cat -noise"s, DocumentStatus::ACTUAL, 6000), 4000);
+    check_results(examination.FindTopDocuments(std::execution::par, "cat -noise"s, DocumentStatus::ACTUAL, 6000), 4000);
+    check_results(examination.FindTopDocuments(executor, "cat dog -noise"s, DocumentStatus::ACTUAL, 6000), 4000);
+    check_results(examination.FindTopDocuments("dog -noise -city"s, [](int document_id, DocumentStatus status, int rating) { return rating > 10; }), 5);
+    ASSERT(examination.FindTopDocuments("noise -noise"s, DocumentStatus::ACTUAL, 6000).empty());
+}
+void TestRequiredWords() {
+    // A rare required word next to a common one, over sealed segments and
+    // the mutable one
+    SearchServer examination;
+    std::vector<std::string> texts;
+    for (int document_id = 0; document_id < 6000; ++document_id) {
+        texts.push_back("cat"s + (document_id % 100 == 0 ? " rare"s : ""s) + (document_id % 2 == 0 ? " dog"s : ""s) + (document_id % 300 == 0 ? " noise"s : ""s));
+    }
+    for (int document_id = 0; document_id < 6000; ++document_id) {
+        examination.AddDocument(document_id, texts[document_id], DocumentStatus::ACTUAL, { document_id % 7 });
+    }
+    QueryExecutor executor(2);
+
+    // Required words score like plus words, on the documents containing all of them
+    const std::vector<Document> disjunctive = examination.FindTopDocuments("rare dog cat -noise"s, DocumentStatus::ACTUAL, 6000);
+    std::vector<Document> expected;
+    for (const Document& document : disjunctive) {
+        if (document.id % 100 == 0) {
+            expected.push_back(document);
+        }
+    }
+    ASSERT_EQUAL(expected.size(), 40);
+    // Equal scores and ratings leave the order open, so documents are compared by id
+    const auto same_results = [](std::vector<Document> lhs, std::vector<Document> rhs) {
+        if (lhs.size() != rhs.size()) {
+            return false;
+        }
+        const auto by_id = [](const Document& lhs, const Document& rhs) {
+            return lhs.id < rhs.id;
+        };
+        std::sort(lhs.begin(), lhs.end(), by_id);
+        std::sort(rhs.begin(), rhs.end(), by_id);
+        for (size_t i = 0; i < lhs.size(); ++i) {
+            if (lhs[i].id != rhs[i].id || std::abs(lhs[i].relevance - rhs[i].relevance) > 1e-6 || lhs[i].rating != rhs[i].rating) {
+                return false;
+            }
+        }
+        return true;
+    };
+    ASSERT(same_results(examination.FindTopDocuments("+rare dog +cat -noise"s, DocumentStatus::ACTUAL, 6000), expected));
+    ASSERT(same_results(examination.FindTopDocuments(std::execution::par, "+rare dog +cat -noise"s, DocumentStatus::ACTUAL, 6000), expected));
+    ASSERT(same_results(examination.FindTopDocuments(executor, "+rare dog +cat -noise"s, DocumentStatus::ACTUAL, 6000), expected));
+    ASSERT(same_results(examination.FindTopDocuments(examination.PrepareQuery("+rare dog +cat -noise"s), DocumentStatus::ACTUAL, 6000), expected));
+    for (const Document& document : examination.FindTopDocuments("+rare dog +cat -noise"s)) {
+        ASSERT_EQUAL(document.id % 100, 0);
+    }
+    ASSERT_EQUAL(examination.FindTopDocuments("+rare +dog"s, [](int document_id, DocumentStatus status, int rating) { return rating == 0; }, 6000).size(), 9);
+
+    // The cache tells a required word from an optional one
+    ASSERT_EQUAL(examination.FindTopDocuments("cat rare"s, DocumentStatus::ACTUAL, 6000).size(), 6000);
+    ASSERT_EQUAL(examination.FindTopDocuments("cat +rare"s, DocumentStatus::ACTUAL, 6000).size(), 60);
+    ASSERT(examination.FindTopDocuments("cat +unicorn"s).empty());
+
+    const auto [matched_words, status] = examination.MatchDocument("+rare dog"s, 2);
+    ASSERT(matched_words.empty());
+    ASSERT_EQUAL(std::get<0>(examination.MatchDocument("+rare dog"s, 200)).size(), 2);
+
+    for (const std::string& query : { "+"s, "++cat"s, "+-cat"s, "cat +dog-"s }) {
+        bool is_thrown = false;
+        try {
+            examination.FindTopDocuments(query);
+        }
+        catch (const std::invalid_argument&) {
+            is_thrown = true;
+        }
+        ASSERT_HINT(is_thrown, "Misplaced '+' must be rejected"s);
+    }
+}
+void TestHugeTopK() {
+    // A top_k far above the document count must neither allocate for it nor throw
+    SearchServer examination;
+    examination.AddDocument(0, "cat in the city"s, DocumentStatus::ACTUAL, { 1 });
+    examination.AddDocument(1, "dog in the park"s, DocumentStatus::ACTUAL, { 2 });
+    QueryExecutor executor(2);
+    const size_t huge = std::numeric_limits<size_t>::max();
+    ASSERT_EQUAL(examination.FindTopDocuments("cat dog"s, DocumentStatus::ACTUAL, huge).size(), 2);
+    ASSERT_EQUAL(examination.FindTopDocuments(std::execution::par, "cat dog"s, DocumentStatus::ACTUAL, huge).size(), 2);
+    ASSERT_EQUAL(examination.FindTopDocuments(executor, "cat dog"s, DocumentStatus::ACTUAL, huge).size(), 2);
+    ASSERT_EQUAL(examination.FindTopDocuments("+cat dog"s, DocumentStatus::ACTUAL, huge).size(), 1);
+    ASSERT_EQUAL(examination.FindTopDocuments("cat dog"s, [](int document_id, DocumentStatus status, int rating) { return rating > 1; }, huge).size(), 1);
+    ASSERT_EQUAL(examination.FindTopDocumentsScored(Bm25Scoring(), "cat dog"s, DocumentStatus::ACTUAL, 100000000).size(), 2);
+
+    ShardedSearchServer sharded(""s, 2);
+    sharded.AddDocument(0, "cat"s, DocumentStatus::ACTUAL, { 1 });
+    sharded.AddDocument(1, "cat dog"s, DocumentStatus::ACTUAL, { 1 });
+    ASSERT_EQUAL(sharded.FindTopDocuments("cat"s, DocumentStatus::ACTUAL, huge).size(), 2);
+}
+void TestCopySearchServer() {
+    SearchServer original("in the"s);
+    for (int document_id = 0; document_id < 5000; ++document_id) {
+        original.AddDocument(document_id, document_id % 2 == 0 ? "cat in the city"s : "dog in the park"s, DocumentStatus::ACTUAL, { document_id });
+    }
+    const SearchServer::PreparedQuery prepared_query = original.PrepareQuery("cat"s);
+    ASSERT_EQUAL(original.FindTopDocuments(prepared_query, DocumentStatus::ACTUAL, 5000).size(), 2500);
+
+    // Copies evolve independently, including their term numbering
+    SearchServer copy = original;
+    copy.RemoveDocument(0);
+    copy.Compact();
+    copy.AddDocument(5000, "bird cat"s, DocumentStatus::ACTUAL, { 1 });
+    original.AddDocument(5000, "fish"s, DocumentStatus::ACTUAL, { 1 });
+    ASSERT_EQUAL(original.FindTopDocuments(prepared_query, DocumentStatus::ACTUAL, 5000).size(), 2500);
+    ASSERT_EQUAL(copy.FindTopDocuments(prepared_query, DocumentStatus::ACTUAL, 5000).size(), 2500);
+    ASSERT(original.FindTopDocuments("bird"s).empty());
+    ASSERT(copy.FindTopDocuments("fish"s).empty());
+    ASSERT_EQUAL(std::get<0>(original.MatchDocument("cat"s, 0)).size(), 1);
+
+    copy = original;
+    ASSERT_EQUAL(copy.GetDocumentCount(), 5001);
+    ASSERT_EQUAL(copy.FindTopDocuments("fish"s).size(), 1);
+}
 
 
 
@@ -168,6 +986,7 @@ void TestStatusSorting() {
 
 void TestSearchServer() {
     RUN_TEST(TestAddDocument);
+    RUN_TEST(TestAddDocuments);
     RUN_TEST(TestMinusWords);
     RUN_TEST(TestStopWords);
     RUN_TEST(TestMatchDocument_);
@@ -175,4 +994,24 @@ void TestSearchServer() {
     RUN_TEST(TestRankingCalculations);
     RUN_TEST(TestPredicat);
     RUN_TEST(TestStatusSorting);
+    RUN_TEST(TestTopDocumentsLimit);
+    RUN_TEST(TestCompact);
+    RUN_TEST(TestTombstones);
+    RUN_TEST(TestCompactRenumbersOrdinals);
+    RUN_TEST(TestSnapshot);
+    RUN_TEST(TestSegments);
+    RUN_TEST(TestPostingListCompression);
+    RUN_TEST(TestConcurrentSearchServer);
+    RUN_TEST(TestConcurrentMap);
+    RUN_TEST(TestQueryExecutor);
+    RUN_TEST(TestQueryCache);
+    RUN_TEST(TestPreparedQuery);
+    RUN_TEST(TestShardedSearchServer);
+    RUN_TEST(TestNetworkServer);
+    RUN_TEST(TestImpactOrderedPostings);
+    RUN_TEST(TestFiltersAndScoringPolicies);
+    RUN_TEST(TestMinusWordsExcludeEverywhere);
+    RUN_TEST(TestRequiredWords);
+    RUN_TEST(TestHugeTopK);
+    RUN_TEST(TestCopySearchServer);
 }
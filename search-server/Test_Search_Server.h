@@ -1,5 +1,7 @@
 #pragma once
 
+#include <type_traits>
+
 #include "string_processing.h"
 
 using std::string_literals::operator""s;
@@ -61,10 +63,24 @@ std::ostream& operator<<(std::ostream& out, const std::map<key, value>& containe
     return out;
 }
 
+// Integers of different signedness are compared by value
+template <typename T, typename U>
+bool AreEqual(const T& t, const U& u) {
+    if constexpr (std::is_integral_v<T> && std::is_integral_v<U> && std::is_signed_v<T> && !std::is_signed_v<U>) {
+        return t >= 0 && static_cast<std::make_unsigned_t<T>>(t) == u;
+    }
+    else if constexpr (std::is_integral_v<T> && std::is_integral_v<U> && !std::is_signed_v<T> && std::is_signed_v<U>) {
+        return AreEqual(u, t);
+    }
+    else {
+        return t == u;
+    }
+}
+
 template <typename T, typename U>
 void AssertEqualImpl(const T& t, const U& u, const std::string& t_str, const std::string& u_str, const std::string& file,
     const std::string& func, unsigned line, const std::string& hint) {
-    if (t != u) {
+    if (!AreEqual(t, u)) {
         std::cout << std::boolalpha;
         std::cout << file << "("s << line << "): "s << func << ": "s;
         std::cout << "ASSERT_EQUAL("s << t_str << ", "s << u_str << ") failed: "s;
@@ -89,6 +105,7 @@ void AssertImpl(bool value, const std::string& expr_str, const std::string& file
 #define ASSERT_HINT(expr, hint) AssertImpl(!!(expr), #expr, __FILE__, __FUNCTION__, __LINE__, (hint))
 
 void TestAddDocument();
+void TestAddDocuments();
 void TestMinusWords();
 void TestStopWords();
 void TestMatchDocument_();
@@ -96,6 +113,24 @@ void TestRelevanceSorting();
 void TestRankingCalculations();
 void TestPredicat();
 void TestStatusSorting();
+void TestTopDocumentsLimit();
+void TestCompact();
+void TestTombstones();
+void TestSnapshot();
+void TestSegments();
+void TestConcurrentSearchServer();
+void TestConcurrentMap();
+void TestQueryExecutor();
+void TestQueryCache();
+void TestPreparedQuery();
+void TestShardedSearchServer();
+void TestNetworkServer();
+void TestImpactOrderedPostings();
+void TestFiltersAndScoringPolicies();
+void TestMinusWordsExcludeEverywhere();
+void TestRequiredWords();
+void TestHugeTopK();
+void TestCopySearchServer();
 
 template <typename T>
 void RunTestImpl(T func, const std::string& name) {
@@ -1,59 +1,111 @@
 #pragma once
 
 
+#include <atomic>
+#include <cstdint>
 #include <cstdlib>
-#include <map>
-#include <mutex>
+#include <limits>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#include <algorithm>
 
     using namespace std::string_literals;
 
+    // Fixed-capacity open-addressing hash map with linear probing. Every
+    // operation is lock-free: keys are claimed with a compare-and-swap and
+    // values are accumulated atomically, so any number of threads may call
+    // Add and erase at the same time. An erased key stays erased: later
+    // additions to it are dropped, whatever order they race in.
     template <typename Key, typename Value>
     class ConcurrentMap {
-    private:
-        struct Bucket {
-            std::mutex mutex;
-            std::map<Key, Value> map;
-        };
-
     public:
-        static_assert(std::is_integral_v<Key>, "ConcurrentMap supports only integer keys"s);
+        static_assert(std::is_integral_v<Key>, "ConcurrentMap supports only integer keys");
+        static_assert(std::is_arithmetic_v<Value>, "ConcurrentMap supports only arithmetic values");
 
-        struct Access {
-            std::lock_guard<std::mutex> guard;
-            Value& ref_to_value;
+        // The largest key value marks empty slots and cannot be stored
+        static constexpr Key EMPTY_KEY = std::numeric_limits<Key>::max();
 
-            Access(const Key& key, Bucket& bucket)
-                : guard(bucket.mutex)
-                , ref_to_value(bucket.map[key]) {
+        // capacity is the number of distinct keys the map must be able to hold
+        explicit ConcurrentMap(size_t capacity) {
+            size_t slot_count = 1;
+            while (slot_count < 2 * capacity) {
+                slot_count *= 2;
             }
-        };
+            slots_ = std::make_unique<Slot[]>(slot_count);
+            mask_ = slot_count - 1;
+        }
 
-        explicit ConcurrentMap(size_t bucket_count)
-            : buckets_(bucket_count) {
+        void Add(const Key& key, Value delta) {
+            Slot& slot = FindOrInsert(key);
+            if (slot.erased.load(std::memory_order_relaxed)) {
+                return;
+            }
+            if constexpr (std::is_integral_v<Value>) {
+                slot.value.fetch_add(delta, std::memory_order_relaxed);
+            }
+            else {
+                Value current = slot.value.load(std::memory_order_relaxed);
+                while (!slot.value.compare_exchange_weak(current, current + delta, std::memory_order_relaxed)) {
+                }
+            }
         }
 
-        Access operator[](const Key& key) {
-            auto& bucket = buckets_[static_cast<uint64_t>(key) % buckets_.size()];
-            return { key, bucket };
+        void erase(const Key& key) {
+            FindOrInsert(key).erased.store(true, std::memory_order_relaxed);
         }
 
-        std::map<Key, Value> BuildOrdinaryMap() {
-            std::map<Key, Value> result;
-            for (auto& [mutex, map] : buckets_) {
-                std::lock_guard g(mutex);
-                result.insert(map.begin(), map.end());
+        // Live keys with their values sorted by key; meant to be called once
+        // the writers are done
+        std::vector<std::pair<Key, Value>> BuildSortedVector() const {
+            std::vector<std::pair<Key, Value>> result;
+            for (size_t index = 0; index <= mask_; ++index) {
+                const Slot& slot = slots_[index];
+                const Key key = slot.key.load(std::memory_order_acquire);
+                if (key != EMPTY_KEY && !slot.erased.load(std::memory_order_relaxed)) {
+                    result.emplace_back(key, slot.value.load(std::memory_order_relaxed));
+                }
             }
+            std::sort(result.begin(), result.end());
             return result;
         }
-        void erase(const Key& key) {
-            size_t bucket_index = static_cast<size_t>(key) % buckets_.size();
-            buckets_[bucket_index].map.erase(key);
-        }
 
     private:
-        std::vector<Bucket> buckets_;
+        struct Slot {
+            std::atomic<Key> key{ EMPTY_KEY };
+            std::atomic<Value> value{ 0 };
+            std::atomic<bool> erased{ false };
+        };
+
+        std::unique_ptr<Slot[]> slots_;
+        size_t mask_;
+
+        size_t Hash(const Key& key) const {
+            // Fibonacci hashing spreads consecutive keys over the table
+            return static_cast<size_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> 32);
+        }
+
+        Slot& FindOrInsert(const Key& key) {
+            if (key == EMPTY_KEY) {
+                throw std::invalid_argument("ConcurrentMap cannot store the reserved empty key"s);
+            }
+            size_t index = Hash(key) & mask_;
+            for (size_t probe = 0; probe <= mask_; ++probe, index = (index + 1) & mask_) {
+                Slot& slot = slots_[index];
+                Key current = slot.key.load(std::memory_order_acquire);
+                if (current == EMPTY_KEY
+                    && slot.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+                    return slot;
+                }
+                // Either the slot was taken before or another thread has just
+                // claimed it, possibly for the same key
+                if (current == key) {
+                    return slot;
+                }
+            }
+            throw std::length_error("ConcurrentMap is full"s);
+        }
     };
-   
-    
@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "concurrent_search_server.h"
+
+    ConcurrentSearchServer::ConcurrentSearchServer(const std::string& stop_words)
+        :servers_{ SearchServer(stop_words), SearchServer(stop_words) }
+    {}
+
+    void ConcurrentSearchServer::AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {
+        Write([document_id, document, status, &ratings](SearchServer& search_server) {
+            search_server.AddDocument(document_id, document, status, ratings);
+        });
+    }
+
+    void ConcurrentSearchServer::AddDocuments(const std::vector<SearchServer::BatchDocument>& documents) {
+        Write([&documents](SearchServer& search_server) {
+            search_server.AddDocuments(documents);
+        });
+    }
+
+    void ConcurrentSearchServer::RemoveDocument(int document_id) {
+        Write([document_id](SearchServer& search_server) {
+            search_server.RemoveDocument(document_id);
+        });
+    }
+
+    void ConcurrentSearchServer::Compact() {
+        Write([](SearchServer& search_server) {
+            search_server.Compact();
+        });
+    }
+
+    std::vector<Document> ConcurrentSearchServer::FindTopDocuments(std::string_view raw_query, DocumentStatus status, size_t top_k) const {
+        return Read([raw_query, status, top_k](const SearchServer& search_server) {
+            return search_server.FindTopDocuments(raw_query, status, top_k);
+        });
+    }
+
+    std::tuple<std::vector<std::string>, DocumentStatus> ConcurrentSearchServer::MatchDocument(std::string_view raw_query, int document_id) const {
+        return Read([raw_query, document_id](const SearchServer& search_server) {
+            const auto [words, status] = search_server.MatchDocument(raw_query, document_id);
+            return std::tuple<std::vector<std::string>, DocumentStatus>(std::vector<std::string>(words.begin(), words.end()), status);
+        });
+    }
+
+    int ConcurrentSearchServer::GetDocumentCount() const {
+        return Read([](const SearchServer& search_server) {
+            return search_server.GetDocumentCount();
+        });
+    }
+
+    uint64_t ConcurrentSearchServer::GetVersion() const {
+        return version_.load();
+    }
+
+    // Readers leave within one query, so the writer first yields a few times
+    // and then sleeps for doubling intervals instead of burning a core
+    void ConcurrentSearchServer::WaitForReaders(int version_index) const {
+        const int YIELD_COUNT = 64;
+        const std::chrono::microseconds MAX_SLEEP(1000);
+        std::chrono::microseconds sleep(1);
+        for (int attempt = 0; read_indicators_[version_index].readers.load() != 0; ++attempt) {
+            if (attempt < YIELD_COUNT) {
+                std::this_thread::yield();
+            }
+            else {
+                std::this_thread::sleep_for(sleep);
+                sleep = std::min(sleep * 2, MAX_SLEEP);
+            }
+        }
+    }
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+
+#include "search_server.h"
+
+// Lets queries run while documents are being added or removed. Two copies of
+// the index are kept (left-right): readers go to the published copy without
+// taking any lock, the writer updates the other copy, publishes it and, once
+// the readers of the previous copy have left, replays the update there.
+// Readers never wait and always see the index between two whole updates.
+class ConcurrentSearchServer {
+public:
+    explicit ConcurrentSearchServer(const std::string& stop_words);
+    template <typename Collection>
+    explicit ConcurrentSearchServer(const Collection& stop_words);
+
+    void AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+    void AddDocuments(const std::vector<SearchServer::BatchDocument>& documents);
+    void RemoveDocument(int document_id);
+    void Compact();
+
+    // Calls reader(const SearchServer&) on the current version of the index
+    template <typename Reader>
+    auto Read(Reader reader) const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status = DocumentStatus::ACTUAL, size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate, size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+    // Words are copied out: views into an index copy would dangle once the
+    // writer replays a Compact or a removal on it
+    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(std::string_view raw_query, int document_id) const;
+    int GetDocumentCount() const;
+    // Number of updates published so far
+    uint64_t GetVersion() const;
+
+private:
+    struct alignas(64) ReadIndicator {
+        std::atomic<int> readers{ 0 };
+    };
+
+    SearchServer servers_[2];
+    std::atomic<int> published_{ 0 };
+    // Readers announce themselves in one of two indicators, so the writer
+    // can wait for the earlier readers while new ones keep arriving
+    std::atomic<int> version_index_{ 0 };
+    mutable ReadIndicator read_indicators_[2];
+    std::atomic<uint64_t> version_{ 0 };
+    std::mutex write_mutex_;
+
+    template <typename Writer>
+    void Write(Writer writer);
+    void WaitForReaders(int version_index) const;
+};
+
+template <typename Collection>
+ConcurrentSearchServer::ConcurrentSearchServer(const Collection& stop_words)
+    :servers_{ SearchServer(stop_words), SearchServer(stop_words) }
+{}
+
+template <typename Reader>
+auto ConcurrentSearchServer::Read(Reader reader) const {
+    struct Departure {
+        ReadIndicator& indicator;
+        ~Departure() {
+            indicator.readers.fetch_sub(1);
+        }
+    };
+    ReadIndicator& indicator = read_indicators_[version_index_.load()];
+    indicator.readers.fetch_add(1);
+    Departure departure{ indicator };
+    return reader(servers_[published_.load()]);
+}
+
+template <typename DocumentPredicate>
+std::vector<Document> ConcurrentSearchServer::FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate, size_t top_k) const {
+    return Read([raw_query, &document_predicate, top_k](const SearchServer& search_server) {
+        return search_server.FindTopDocuments(raw_query, document_predicate, top_k);
+    });
+}
+
+template <typename Writer>
+void ConcurrentSearchServer::Write(Writer writer) {
+    std::lock_guard guard(write_mutex_);
+    const int published = published_.load();
+    // Updates either throw before changing anything or succeed, so an
+    // exception here leaves both copies as they were
+    writer(servers_[1 - published]);
+    published_.store(1 - published);
+    ++version_;
+
+    const int version_index = version_index_.load();
+    WaitForReaders(1 - version_index);
+    version_index_.store(1 - version_index);
+    WaitForReaders(version_index);
+    writer(servers_[published]);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <iostream>
+
 enum DocumentStatus {
     ACTUAL,
     IRRELEVANT,
@@ -0,0 +1,9 @@
+#include "document_filter.h"
+
+bool StatusFilter::operator()(int, DocumentStatus document_status, int) const {
+    return document_status == status;
+}
+
+bool RatingRange::operator()(int, DocumentStatus, int rating) const {
+    return rating >= min_rating && rating <= max_rating;
+}
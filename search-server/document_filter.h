@@ -0,0 +1,22 @@
+#pragma once
+
+#include "document.h"
+
+// Document predicates of common shapes. They are accepted wherever a
+// predicate is, and SearchServer recognizes them at compile time: instead
+// of calling them for every posting it answers them from per-status bitmaps
+// and the rating column.
+
+struct StatusFilter {
+    DocumentStatus status;
+
+    bool operator()(int document_id, DocumentStatus document_status, int rating) const;
+};
+
+// Ratings from min_rating to max_rating inclusive
+struct RatingRange {
+    int min_rating;
+    int max_rating;
+
+    bool operator()(int document_id, DocumentStatus status, int rating) const;
+};
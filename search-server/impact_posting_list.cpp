@@ -0,0 +1,58 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "impact_posting_list.h"
+
+ImpactPostingList::ImpactPostingList(const PostingList& postings) {
+    std::vector<int> document_ids;
+    std::vector<double> term_freqs;
+    document_ids.reserve(postings.size());
+    term_freqs.reserve(postings.size());
+    for (PostingList::Cursor cursor(postings); !cursor.IsAtEnd(); cursor.Next()) {
+        document_ids.push_back(cursor.GetDocumentId());
+        term_freqs.push_back(cursor.GetTermFreq());
+    }
+    if (document_ids.empty()) {
+        return;
+    }
+    impact_unit_ = *std::max_element(term_freqs.begin(), term_freqs.end()) / MAX_IMPACT;
+    std::vector<uint16_t> impacts(document_ids.size());
+    for (size_t position = 0; position < document_ids.size(); ++position) {
+        const double impact = impact_unit_ > 0.0 ? std::ceil(term_freqs[position] / impact_unit_) : 1.0;
+        impacts[position] = static_cast<uint16_t>(std::clamp(impact, 1.0, static_cast<double>(MAX_IMPACT)));
+    }
+
+    // A stable sort keeps the documents of every group in id order
+    std::vector<uint32_t> order(document_ids.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+        [&impacts](uint32_t lhs, uint32_t rhs) {
+            return impacts[lhs] > impacts[rhs];
+        });
+    document_ids_.reserve(order.size());
+    for (const uint32_t position : order) {
+        if (groups_.empty() || groups_.back().impact != impacts[position]) {
+            groups_.push_back({ impacts[position], 0 });
+        }
+        document_ids_.push_back(document_ids[position]);
+        groups_.back().end = static_cast<uint32_t>(document_ids_.size());
+    }
+    groups_.shrink_to_fit();
+}
+
+double ImpactPostingList::GetImpactUnit() const {
+    return impact_unit_;
+}
+
+const std::vector<ImpactPostingList::Group>& ImpactPostingList::GetGroups() const {
+    return groups_;
+}
+
+const std::vector<int>& ImpactPostingList::GetDocumentIds() const {
+    return document_ids_;
+}
+
+size_t ImpactPostingList::size() const {
+    return document_ids_.size();
+}
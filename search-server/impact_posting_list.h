@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "posting_list.h"
+
+// Impact-ordered copy of a posting list. Every term frequency is quantized
+// to 16 bits relative to the largest one of the list, documents with equal
+// impacts form a group, and groups go from the highest impact down, so a
+// reader can take the postings that contribute most first. Inside a group
+// document ids stay sorted.
+class ImpactPostingList {
+public:
+    static const uint16_t MAX_IMPACT = UINT16_MAX;
+
+    struct Group {
+        uint16_t impact;
+        // One past the position of the group's last posting
+        uint32_t end;
+    };
+
+    ImpactPostingList() = default;
+    explicit ImpactPostingList(const PostingList& postings);
+
+    // Term frequencies of a group's documents lie in
+    // ((impact - 1) * unit, impact * unit]
+    double GetImpactUnit() const;
+
+    const std::vector<Group>& GetGroups() const;
+    const std::vector<int>& GetDocumentIds() const;
+    size_t size() const;
+
+private:
+    std::vector<int> document_ids_;
+    std::vector<Group> groups_;
+    double impact_unit_ = 0.0;
+};
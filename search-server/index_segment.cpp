@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <climits>
+#include <execution>
+#include <numeric>
+#include <utility>
+
+#include "index_segment.h"
+
+IndexSegment::IndexSegment(int first_ordinal)
+    :first_ordinal_(first_ordinal), end_ordinal_(INT_MAX)
+{}
+
+PostingList& IndexSegment::GetPostings(TermId term) {
+    const auto [it, inserted] = term_positions_.emplace(term, terms_.size());
+    if (inserted) {
+        terms_.push_back(term);
+        postings_.emplace_back();
+    }
+    return postings_[it->second];
+}
+
+PostingList* IndexSegment::FindPostings(TermId term) {
+    return const_cast<PostingList*>(std::as_const(*this).FindPostings(term));
+}
+
+void IndexSegment::Seal(int end_ordinal) {
+    std::vector<size_t> order(terms_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+        [this](size_t lhs, size_t rhs) {
+            return terms_[lhs] < terms_[rhs];
+        });
+    std::vector<TermId> terms;
+    std::vector<PostingList> postings;
+    terms.reserve(order.size());
+    postings.reserve(order.size());
+    for (const size_t position : order) {
+        terms.push_back(terms_[position]);
+        postings.push_back(std::move(postings_[position]));
+        postings.back().ShrinkToFit();
+    }
+    std::for_each(std::execution::par, postings.begin(), postings.end(),
+        [](PostingList& postings) {
+            postings.Compress();
+        });
+    terms_ = std::move(terms);
+    postings_ = std::move(postings);
+    term_positions_ = {};
+    end_ordinal_ = end_ordinal;
+    is_sealed_ = true;
+}
+
+void IndexSegment::BuildImpactPostings() {
+    std::vector<ImpactPostingList> impact_postings(postings_.size());
+    std::transform(std::execution::par, postings_.begin(), postings_.end(), impact_postings.begin(),
+        [](const PostingList& postings) {
+            return ImpactPostingList(postings);
+        });
+    impact_postings_ = std::move(impact_postings);
+    has_impact_postings_ = true;
+}
+
+void IndexSegment::DropImpactPostings() {
+    impact_postings_ = {};
+    has_impact_postings_ = false;
+}
+
+bool IndexSegment::HasImpactPostings() const {
+    return has_impact_postings_;
+}
+
+const ImpactPostingList* IndexSegment::FindImpactPostings(TermId term) const {
+    if (!has_impact_postings_) {
+        return nullptr;
+    }
+    const auto it = std::lower_bound(terms_.begin(), terms_.end(), term);
+    if (it == terms_.end() || *it != term) {
+        return nullptr;
+    }
+    return &impact_postings_[it - terms_.begin()];
+}
+
+const PostingList* IndexSegment::FindPostings(TermId term) const {
+    if (!is_sealed_) {
+        const auto it = term_positions_.find(term);
+        return it == term_positions_.end() ? nullptr : &postings_[it->second];
+    }
+    const auto it = std::lower_bound(terms_.begin(), terms_.end(), term);
+    if (it == terms_.end() || *it != term) {
+        return nullptr;
+    }
+    return &postings_[it - terms_.begin()];
+}
+
+int IndexSegment::GetFirstOrdinal() const {
+    return first_ordinal_;
+}
+
+int IndexSegment::GetEndOrdinal() const {
+    return end_ordinal_;
+}
+
+bool IndexSegment::IsSealed() const {
+    return is_sealed_;
+}
+
+const std::vector<TermId>& IndexSegment::GetTerms() const {
+    return terms_;
+}
+
+const std::vector<PostingList>& IndexSegment::GetPostingLists() const {
+    return postings_;
+}
+
+void IndexSegment::Renumber(const std::vector<bool>& tombstones, const std::vector<int>& new_ordinals) {
+    const bool is_sealed = is_sealed_;
+    std::for_each(std::execution::par, postings_.begin(), postings_.end(),
+        [&tombstones, &new_ordinals, is_sealed](PostingList& postings) {
+            postings.EraseIf([&tombstones](int ordinal) {
+                return tombstones[ordinal];
+            });
+            postings.RemapDocumentIds(new_ordinals);
+            if (is_sealed) {
+                postings.ShrinkToFit();
+                postings.Compress();
+            }
+        });
+    first_ordinal_ = new_ordinals[first_ordinal_];
+    if (is_sealed_) {
+        end_ordinal_ = new_ordinals[end_ordinal_];
+    }
+    if (has_impact_postings_) {
+        BuildImpactPostings();
+    }
+}
+
+void IndexSegment::RemapTerms(const std::vector<TermId>& new_terms) {
+    size_t kept = 0;
+    for (size_t position = 0; position < terms_.size(); ++position) {
+        const TermId term = new_terms[terms_[position]];
+        if (term == TermDictionary::NO_TERM || postings_[position].empty()) {
+            continue;
+        }
+        terms_[kept] = term;
+        if (kept != position) {
+            postings_[kept] = std::move(postings_[position]);
+            if (has_impact_postings_) {
+                impact_postings_[kept] = std::move(impact_postings_[position]);
+            }
+        }
+        ++kept;
+    }
+    terms_.resize(kept);
+    postings_.resize(kept);
+    if (has_impact_postings_) {
+        impact_postings_.resize(kept);
+    }
+    if (!is_sealed_) {
+        term_positions_.clear();
+        for (size_t position = 0; position < terms_.size(); ++position) {
+            term_positions_[terms_[position]] = position;
+        }
+    }
+}
+
+std::shared_ptr<IndexSegment> IndexSegment::Merge(const std::vector<std::shared_ptr<const IndexSegment>>& segments, const std::vector<bool>& tombstones) {
+    auto merged = std::make_shared<IndexSegment>(segments.front()->first_ordinal_);
+    std::vector<TermId> terms;
+    for (const auto& segment : segments) {
+        terms.insert(terms.end(), segment->terms_.begin(), segment->terms_.end());
+    }
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+    // Sealed segments keep their terms sorted, so one cursor per input suffices
+    std::vector<size_t> positions(segments.size(), 0);
+    for (const TermId term : terms) {
+        PostingList postings;
+        for (size_t s = 0; s < segments.size(); ++s) {
+            const IndexSegment& segment = *segments[s];
+            if (positions[s] < segment.terms_.size() && segment.terms_[positions[s]] == term) {
+                postings.Append(segment.postings_[positions[s]]);
+                ++positions[s];
+            }
+        }
+        postings.EraseIf([&tombstones](int ordinal) {
+            return tombstones[ordinal];
+        });
+        if (postings.empty()) {
+            continue;
+        }
+        postings.ShrinkToFit();
+        postings.Compress();
+        merged->terms_.push_back(term);
+        merged->postings_.push_back(std::move(postings));
+    }
+    merged->end_ordinal_ = segments.back()->end_ordinal_;
+    merged->is_sealed_ = true;
+    if (segments.front()->HasImpactPostings()) {
+        merged->BuildImpactPostings();
+    }
+    return merged;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "impact_posting_list.h"
+#include "posting_list.h"
+#include "term_dictionary.h"
+
+// Postings of the documents whose ordinals fall into one contiguous range.
+// New documents go into the mutable segment; once it is large enough it is
+// sealed: its terms are sorted, the lists are trimmed, and from then on it
+// is only read, merged with its neighbours or compacted.
+class IndexSegment {
+public:
+    explicit IndexSegment(int first_ordinal);
+
+    // Postings of the term, created on first use; only for the mutable segment
+    PostingList& GetPostings(TermId term);
+    // Postings of the term inside this segment or nullptr if it has none
+    PostingList* FindPostings(TermId term);
+    const PostingList* FindPostings(TermId term) const;
+    // Sorts the terms and compresses the lists, which stay compressed
+    // through Renumber and Merge
+    void Seal(int end_ordinal);
+    // Impact-ordered copies of the lists of a sealed segment; they follow
+    // the lists through Renumber, RemapTerms and Merge until dropped
+    void BuildImpactPostings();
+    void DropImpactPostings();
+    bool HasImpactPostings() const;
+    // Impact-ordered postings of the term or nullptr if the segment has none
+    const ImpactPostingList* FindImpactPostings(TermId term) const;
+
+    int GetFirstOrdinal() const;
+    // One past the last ordinal; only meaningful for sealed segments
+    int GetEndOrdinal() const;
+    bool IsSealed() const;
+
+    const std::vector<TermId>& GetTerms() const;
+    const std::vector<PostingList>& GetPostingLists() const;
+
+    // Erases the postings of documents whose ordinals are marked in
+    // tombstones and renumbers the others to new_ordinals[ordinal], the
+    // number of live ordinals before it; the ordinal range shrinks alike
+    void Renumber(const std::vector<bool>& tombstones, const std::vector<int>& new_ordinals);
+    // Renumbers terms after the dictionary has been compacted; terms mapped
+    // to TermDictionary::NO_TERM and empty lists are dropped. The mapping
+    // must keep the relative order of the surviving terms.
+    void RemapTerms(const std::vector<TermId>& new_terms);
+
+    // Concatenates adjacent sealed segments given in ordinal order, leaving
+    // out the documents marked in tombstones
+    static std::shared_ptr<IndexSegment> Merge(const std::vector<std::shared_ptr<const IndexSegment>>& segments, const std::vector<bool>& tombstones);
+
+private:
+    int first_ordinal_;
+    int end_ordinal_;
+    bool is_sealed_ = false;
+    std::vector<TermId> terms_;
+    std::vector<PostingList> postings_;
+    // Parallel to postings_ while has_impact_postings_ is set
+    std::vector<ImpactPostingList> impact_postings_;
+    bool has_impact_postings_ = false;
+    // Position of every term in terms_ while the segment is mutable
+    std::unordered_map<TermId, size_t> term_positions_;
+};
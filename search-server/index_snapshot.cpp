@@ -0,0 +1,153 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+
+#include "index_snapshot.h"
+
+using std::string_literals::operator""s;
+
+namespace {
+
+const size_t SNAPSHOT_ALIGNMENT = 8;
+const size_t WRITE_BUFFER_SIZE = 1 << 20;
+
+} // namespace
+
+MappedFile::MappedFile(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open snapshot "s + path);
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        throw std::runtime_error("cannot stat snapshot "s + path);
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+    if (size_ > 0) {
+        void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("cannot map snapshot "s + path);
+        }
+        data_ = static_cast<const char*>(mapping);
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+const char* MappedFile::data() const {
+    return data_;
+}
+
+size_t MappedFile::size() const {
+    return size_;
+}
+
+SnapshotWriter::SnapshotWriter(const std::string& path)
+    :path_(path), temp_path_(path + ".tmp"s)
+{
+    fd_ = open(temp_path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("cannot create snapshot "s + temp_path_);
+    }
+    buffer_.reserve(WRITE_BUFFER_SIZE);
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    if (fd_ >= 0) {
+        close(fd_);
+        unlink(temp_path_.c_str());
+    }
+}
+
+void SnapshotWriter::Finish() {
+    Flush();
+    if (fsync(fd_) != 0) {
+        throw std::runtime_error("cannot sync snapshot "s + temp_path_);
+    }
+    const int result = close(fd_);
+    fd_ = -1;
+    if (result != 0 || rename(temp_path_.c_str(), path_.c_str()) != 0) {
+        unlink(temp_path_.c_str());
+        throw std::runtime_error("cannot replace snapshot "s + path_);
+    }
+}
+
+void SnapshotWriter::WriteBytes(const char* bytes, size_t count) {
+    buffer_.append(bytes, count);
+    written_ += count;
+    if (buffer_.size() >= WRITE_BUFFER_SIZE) {
+        Flush();
+    }
+}
+
+void SnapshotWriter::Flush() {
+    size_t offset = 0;
+    while (offset < buffer_.size()) {
+        const ssize_t result = write(fd_, buffer_.data() + offset, buffer_.size() - offset);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("failed to write snapshot "s + temp_path_);
+        }
+        offset += static_cast<size_t>(result);
+    }
+    buffer_.clear();
+}
+
+void SnapshotWriter::Align() {
+    static const char padding[SNAPSHOT_ALIGNMENT] = {};
+    const size_t remainder = written_ % SNAPSHOT_ALIGNMENT;
+    if (remainder != 0) {
+        WriteBytes(padding, SNAPSHOT_ALIGNMENT - remainder);
+    }
+}
+
+SnapshotReader::SnapshotReader(const char* data, size_t size)
+    :data_(data), size_(size)
+{}
+
+const char* SnapshotReader::Take(size_t count, size_t element_size) {
+    if (count > (size_ - position_) / element_size) {
+        throw std::invalid_argument("snapshot is truncated"s);
+    }
+    const char* bytes = data_ + position_;
+    position_ += count * element_size;
+    return bytes;
+}
+
+const uint64_t* SnapshotReader::ReadOffsets(uint64_t count) {
+    if (count >= std::numeric_limits<size_t>::max()) {
+        throw std::invalid_argument("snapshot is truncated"s);
+    }
+    const uint64_t* offsets = ReadArray<uint64_t>(static_cast<size_t>(count) + 1);
+    if (offsets[0] != 0) {
+        throw std::invalid_argument("snapshot offsets are corrupt"s);
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+        if (offsets[i + 1] < offsets[i]) {
+            throw std::invalid_argument("snapshot offsets are corrupt"s);
+        }
+    }
+    return offsets;
+}
+
+void SnapshotReader::Align() {
+    const size_t remainder = position_ % SNAPSHOT_ALIGNMENT;
+    if (remainder != 0) {
+        Take(SNAPSHOT_ALIGNMENT - remainder, 1);
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+// Binary snapshot format: an 8-byte magic, a format version and a flags
+// word, followed by sections of plain arrays. Every array starts at an
+// 8-byte aligned offset, so a memory-mapped snapshot can be read in place.
+const char SNAPSHOT_MAGIC[8] = { 'S', 'R', 'C', 'H', 'S', 'N', 'A', 'P' };
+const uint32_t SNAPSHOT_VERSION = 2;
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const;
+    size_t size() const;
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Writes a snapshot into a temporary file next to `path` and renames it
+// over `path` in Finish once it is synced, so a crash never leaves a
+// half-written snapshot and mappings of the old file stay valid. The
+// temporary file is removed if Finish is not reached.
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(const std::string& path);
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    template <typename T>
+    void Write(const T& value);
+    template <typename T>
+    void WriteArray(const T* values, size_t count);
+
+    void Finish();
+
+private:
+    std::string path_;
+    std::string temp_path_;
+    int fd_ = -1;
+    std::string buffer_;
+    size_t written_ = 0;
+
+    void WriteBytes(const char* bytes, size_t count);
+    void Flush();
+    void Align();
+};
+
+class SnapshotReader {
+public:
+    SnapshotReader(const char* data, size_t size);
+
+    template <typename T>
+    T Read();
+    // Returns a pointer into the underlying memory, nothing is copied
+    template <typename T>
+    const T* ReadArray(size_t count);
+    // Reads count + 1 offsets delimiting count ranges; they must start at
+    // zero and never decrease
+    const uint64_t* ReadOffsets(uint64_t count);
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t position_ = 0;
+
+    // Bytes of count elements of the given size, checked against the end
+    const char* Take(size_t count, size_t element_size);
+    void Align();
+};
+
+template <typename T>
+void SnapshotWriter::Write(const T& value) {
+    WriteArray(&value, 1);
+}
+
+template <typename T>
+void SnapshotWriter::WriteArray(const T* values, size_t count) {
+    static_assert(std::is_trivially_copyable_v<T>, "snapshot arrays must be trivially copyable");
+    Align();
+    WriteBytes(reinterpret_cast<const char*>(values), count * sizeof(T));
+}
+
+template <typename T>
+T SnapshotReader::Read() {
+    return *ReadArray<T>(1);
+}
+
+template <typename T>
+const T* SnapshotReader::ReadArray(size_t count) {
+    static_assert(std::is_trivially_copyable_v<T>, "snapshot arrays must be trivially copyable");
+    Align();
+    return reinterpret_cast<const T*>(Take(count, sizeof(T)));
+}
@@ -0,0 +1,196 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "network_client.h"
+
+using std::string_literals::operator""s;
+
+namespace {
+
+const size_t READ_CHUNK_SIZE = 64 << 10;
+
+std::runtime_error SystemError(const std::string& what) {
+    return std::runtime_error(what + ": "s + std::strerror(errno));
+}
+
+int Connect(int domain, const sockaddr* address, socklen_t address_size, const std::string& name) {
+    const int fd = socket(domain, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw SystemError("cannot create socket"s);
+    }
+    if (connect(fd, address, address_size) < 0) {
+        const std::runtime_error error = SystemError("cannot connect to "s + name);
+        close(fd);
+        throw error;
+    }
+    return fd;
+}
+
+} // namespace
+
+NetworkClient NetworkClient::ConnectTcp(const std::string& address, uint16_t port) {
+    sockaddr_in socket_address{};
+    socket_address.sin_family = AF_INET;
+    socket_address.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &socket_address.sin_addr) != 1) {
+        throw std::invalid_argument("invalid IPv4 address "s + address);
+    }
+    const int fd = Connect(AF_INET, reinterpret_cast<const sockaddr*>(&socket_address), sizeof(socket_address),
+        address + ":"s + std::to_string(port));
+    const int enable = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    return NetworkClient(fd);
+}
+
+NetworkClient NetworkClient::ConnectUnix(const std::string& path) {
+    sockaddr_un socket_address{};
+    socket_address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(socket_address.sun_path)) {
+        throw std::invalid_argument("socket path is too long: "s + path);
+    }
+    std::memcpy(socket_address.sun_path, path.c_str(), path.size() + 1);
+    return NetworkClient(Connect(AF_UNIX, reinterpret_cast<const sockaddr*>(&socket_address), sizeof(socket_address), path));
+}
+
+NetworkClient::NetworkClient(int fd)
+    :fd_(fd)
+{}
+
+NetworkClient::NetworkClient(NetworkClient&& other) noexcept
+    :fd_(std::exchange(other.fd_, -1)), next_request_id_(other.next_request_id_), pending_(std::move(other.pending_)),
+    input_(std::move(other.input_)), output_(std::move(other.output_)), output_offset_(other.output_offset_)
+{}
+
+NetworkClient& NetworkClient::operator=(NetworkClient&& other) noexcept {
+    if (this != &other) {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+        fd_ = std::exchange(other.fd_, -1);
+        next_request_id_ = other.next_request_id_;
+        pending_ = std::move(other.pending_);
+        input_ = std::move(other.input_);
+        output_ = std::move(other.output_);
+        output_offset_ = other.output_offset_;
+    }
+    return *this;
+}
+
+NetworkClient::~NetworkClient() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+uint32_t NetworkClient::Send(Request request) {
+    request.request_id = next_request_id_++;
+    EncodeRequest(request, output_);
+    pending_.push_back(request.type);
+    return request.request_id;
+}
+
+Response NetworkClient::Receive() {
+    if (pending_.empty()) {
+        throw std::logic_error("no request is waiting for a response"s);
+    }
+    while (true) {
+        if (const size_t frame_size = GetFrameSize(input_)) {
+            Response response = DecodeResponse(pending_.front(), GetFramePayload(std::string_view(input_).substr(0, frame_size)));
+            pending_.pop_front();
+            input_.erase(0, frame_size);
+            return response;
+        }
+        // Keep sending while waiting, the server may need room for its
+        // responses before it reads further requests
+        pollfd poll_fd{ fd_, static_cast<short>(POLLIN | (output_offset_ < output_.size() ? POLLOUT : 0)), 0 };
+        if (poll(&poll_fd, 1, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw SystemError("poll failed"s);
+        }
+        if ((poll_fd.revents & POLLOUT) != 0) {
+            const ssize_t count = send(fd_, output_.data() + output_offset_, output_.size() - output_offset_, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                throw SystemError("cannot send request"s);
+            }
+            output_offset_ += std::max<ssize_t>(count, 0);
+            if (output_offset_ == output_.size()) {
+                output_.clear();
+                output_offset_ = 0;
+            }
+        }
+        if ((poll_fd.revents & (POLLIN | POLLHUP | POLLERR)) != 0) {
+            const size_t size = input_.size();
+            input_.resize(size + READ_CHUNK_SIZE);
+            const ssize_t count = recv(fd_, input_.data() + size, READ_CHUNK_SIZE, MSG_DONTWAIT);
+            const int error = errno;
+            input_.resize(size + std::max<ssize_t>(count, 0));
+            if (count == 0) {
+                throw std::runtime_error("connection closed by the server"s);
+            }
+            if (count < 0 && error != EAGAIN && error != EWOULDBLOCK && error != EINTR) {
+                errno = error;
+                throw SystemError("cannot receive response"s);
+            }
+        }
+    }
+}
+
+std::vector<Document> NetworkClient::FindTopDocuments(std::string_view raw_query, DocumentStatus status, size_t top_k) {
+    Request request;
+    request.type = RequestType::FIND_TOP_DOCUMENTS;
+    request.status = status;
+    request.top_k = static_cast<uint32_t>(top_k);
+    request.text = raw_query;
+    return RoundTrip(request).documents;
+}
+
+std::tuple<std::vector<std::string>, DocumentStatus> NetworkClient::MatchDocument(std::string_view raw_query, int document_id) {
+    Request request;
+    request.type = RequestType::MATCH_DOCUMENT;
+    request.document_id = document_id;
+    request.text = raw_query;
+    Response response = RoundTrip(request);
+    return { std::move(response.words), response.status };
+}
+
+void NetworkClient::AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {
+    Request request;
+    request.type = RequestType::ADD_DOCUMENT;
+    request.document_id = document_id;
+    request.status = status;
+    request.ratings = ratings;
+    request.text = document;
+    RoundTrip(request);
+}
+
+void NetworkClient::RemoveDocument(int document_id) {
+    Request request;
+    request.type = RequestType::REMOVE_DOCUMENT;
+    request.document_id = document_id;
+    RoundTrip(request);
+}
+
+Response NetworkClient::RoundTrip(const Request& request) {
+    if (!pending_.empty()) {
+        throw std::logic_error("pipelined responses have to be received first"s);
+    }
+    Send(request);
+    Response response = Receive();
+    if (!response.is_ok) {
+        throw std::runtime_error(response.error);
+    }
+    return response;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "query_protocol.h"
+#include "search_server.h"
+
+// Blocking client of NetworkServer. Requests can be pipelined: Send any
+// number of them, then Receive their responses in the same order. Sending
+// only buffers the request; the buffer is written out while receiving, so
+// a long pipeline cannot deadlock against a server that stops reading.
+class NetworkClient {
+public:
+    static NetworkClient ConnectTcp(const std::string& address, uint16_t port);
+    static NetworkClient ConnectUnix(const std::string& path);
+
+    NetworkClient(NetworkClient&& other) noexcept;
+    NetworkClient& operator=(NetworkClient&& other) noexcept;
+    ~NetworkClient();
+
+    // Assigns the request id and returns it
+    uint32_t Send(Request request);
+    Response Receive();
+
+    // Single round trips, allowed when no pipelined response is pending;
+    // an error reported by the server is thrown as std::runtime_error
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status = DocumentStatus::ACTUAL, size_t top_k = MAX_RESULT_DOCUMENT_COUNT);
+    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(std::string_view raw_query, int document_id);
+    void AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+    void RemoveDocument(int document_id);
+
+private:
+    int fd_ = -1;
+    uint32_t next_request_id_ = 1;
+    // Types of the requests whose responses have not been received yet
+    std::deque<RequestType> pending_;
+    std::string input_;
+    std::string output_;
+    size_t output_offset_ = 0;
+
+    explicit NetworkClient(int fd);
+    Response RoundTrip(const Request& request);
+};
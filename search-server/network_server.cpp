@@ -0,0 +1,324 @@
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "network_server.h"
+
+using std::string_literals::operator""s;
+
+namespace {
+
+const int LISTEN_BACKLOG = 128;
+const int MAX_EVENTS = 64;
+
+bool IsQuery(RequestType type) {
+    return type == RequestType::FIND_TOP_DOCUMENTS || type == RequestType::MATCH_DOCUMENT;
+}
+
+std::runtime_error SystemError(const std::string& what) {
+    return std::runtime_error(what + ": "s + std::strerror(errno));
+}
+
+void SetNonBlocking(int fd) {
+    const int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        throw SystemError("cannot make a socket non-blocking"s);
+    }
+}
+
+} // namespace
+
+NetworkServer::NetworkServer(SearchServer& search_server, size_t worker_count)
+    :search_server_(search_server), executor_(worker_count)
+{
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        throw SystemError("cannot create epoll instance"s);
+    }
+    stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (stop_fd_ < 0) {
+        close(epoll_fd_);
+        throw SystemError("cannot create stop event"s);
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = stop_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, stop_fd_, &event);
+}
+
+NetworkServer::~NetworkServer() {
+    for (const auto& [fd, connection] : connections_) {
+        close(fd);
+    }
+    for (const int fd : listen_fds_) {
+        close(fd);
+    }
+    for (const std::string& path : unix_paths_) {
+        unlink(path.c_str());
+    }
+    close(stop_fd_);
+    close(epoll_fd_);
+}
+
+uint16_t NetworkServer::ListenTcp(const std::string& address, uint16_t port) {
+    sockaddr_in socket_address{};
+    socket_address.sin_family = AF_INET;
+    socket_address.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &socket_address.sin_addr) != 1) {
+        throw std::invalid_argument("invalid IPv4 address "s + address);
+    }
+    const int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw SystemError("cannot create socket"s);
+    }
+    const int enable = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    socklen_t length = sizeof(socket_address);
+    if (bind(fd, reinterpret_cast<const sockaddr*>(&socket_address), sizeof(socket_address)) < 0
+        || listen(fd, LISTEN_BACKLOG) < 0
+        || getsockname(fd, reinterpret_cast<sockaddr*>(&socket_address), &length) < 0) {
+        const std::runtime_error error = SystemError("cannot listen on "s + address + ":"s + std::to_string(port));
+        close(fd);
+        throw error;
+    }
+    AddListener(fd);
+    return ntohs(socket_address.sin_port);
+}
+
+void NetworkServer::ListenUnix(const std::string& path) {
+    sockaddr_un socket_address{};
+    socket_address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(socket_address.sun_path)) {
+        throw std::invalid_argument("socket path is too long: "s + path);
+    }
+    std::memcpy(socket_address.sun_path, path.c_str(), path.size() + 1);
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw SystemError("cannot create socket"s);
+    }
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<const sockaddr*>(&socket_address), sizeof(socket_address)) < 0
+        || listen(fd, LISTEN_BACKLOG) < 0) {
+        const std::runtime_error error = SystemError("cannot listen on "s + path);
+        close(fd);
+        throw error;
+    }
+    unix_paths_.push_back(path);
+    AddListener(fd);
+}
+
+void NetworkServer::Run() {
+    epoll_event events[MAX_EVENTS];
+    while (true) {
+        const int event_count = epoll_wait(epoll_fd_, events, MAX_EVENTS, -1);
+        if (event_count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw SystemError("epoll_wait failed"s);
+        }
+        for (int i = 0; i < event_count; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == stop_fd_) {
+                uint64_t count;
+                [[maybe_unused]] const ssize_t result = read(stop_fd_, &count, sizeof(count));
+                return;
+            }
+            if (std::find(listen_fds_.begin(), listen_fds_.end(), fd) != listen_fds_.end()) {
+                Accept(fd);
+                continue;
+            }
+            const auto it = connections_.find(fd);
+            if (it == connections_.end()) {
+                continue;
+            }
+            Connection& connection = *it->second;
+            bool is_open = (events[i].events & (EPOLLERR | EPOLLHUP)) == 0 || (events[i].events & EPOLLIN) != 0;
+            if (is_open && (events[i].events & EPOLLIN) != 0) {
+                is_open = ReadFrom(connection);
+            }
+            if (is_open && (events[i].events & EPOLLOUT) != 0) {
+                is_open = WriteTo(connection);
+            }
+            if (is_open) {
+                UpdateEvents(connection);
+            }
+            else {
+                Close(fd);
+            }
+        }
+    }
+}
+
+void NetworkServer::Stop() {
+    const uint64_t one = 1;
+    [[maybe_unused]] const ssize_t result = write(stop_fd_, &one, sizeof(one));
+}
+
+void NetworkServer::AddListener(int fd) {
+    SetNonBlocking(fd);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+        const std::runtime_error error = SystemError("cannot watch listening socket"s);
+        close(fd);
+        throw error;
+    }
+    listen_fds_.push_back(fd);
+}
+
+void NetworkServer::Accept(int listen_fd) {
+    while (true) {
+        const int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            // EAGAIN once the backlog is drained; other errors concern the
+            // pending client only
+            return;
+        }
+        // Responses are written in whole batches, Nagle would only delay them
+        const int enable = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+            close(fd);
+            continue;
+        }
+        auto connection = std::make_unique<Connection>();
+        connection->fd = fd;
+        connections_[fd] = std::move(connection);
+    }
+}
+
+bool NetworkServer::ReadFrom(Connection& connection) {
+    // Reading until the socket is drained collects every pipelined request
+    // that has arrived into one batch; the rest of a larger burst is left
+    // for the next event
+    bool is_closed = false;
+    while (connection.input.size() < MAX_BATCH_INPUT) {
+        const size_t size = connection.input.size();
+        connection.input.resize(size + READ_CHUNK_SIZE);
+        const ssize_t count = recv(connection.fd, connection.input.data() + size, READ_CHUNK_SIZE, 0);
+        const int error = errno;
+        connection.input.resize(size + std::max<ssize_t>(count, 0));
+        if (count > 0 || (count < 0 && error == EINTR)) {
+            continue;
+        }
+        is_closed = count == 0 || (error != EAGAIN && error != EWOULDBLOCK);
+        break;
+    }
+    try {
+        ProcessRequests(connection);
+    }
+    catch (const std::invalid_argument&) {
+        // A malformed frame leaves no way to find where the next one starts
+        return false;
+    }
+    return WriteTo(connection) && !is_closed;
+}
+
+bool NetworkServer::WriteTo(Connection& connection) {
+    while (connection.output_offset < connection.output.size()) {
+        const ssize_t count = send(connection.fd, connection.output.data() + connection.output_offset,
+            connection.output.size() - connection.output_offset, MSG_NOSIGNAL);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        connection.output_offset += count;
+    }
+    connection.output.clear();
+    connection.output_offset = 0;
+    return true;
+}
+
+void NetworkServer::ProcessRequests(Connection& connection) {
+    std::vector<Request> requests;
+    size_t consumed = 0;
+    while (const size_t frame_size = GetFrameSize(std::string_view(connection.input).substr(consumed))) {
+        requests.push_back(DecodeRequest(GetFramePayload(std::string_view(connection.input).substr(consumed, frame_size))));
+        consumed += frame_size;
+    }
+
+    std::vector<std::string> responses(requests.size());
+    for (size_t begin = 0; begin < requests.size();) {
+        if (!IsQuery(requests[begin].type)) {
+            Execute(requests[begin], responses[begin]);
+            ++begin;
+            continue;
+        }
+        size_t end = begin;
+        while (end < requests.size() && IsQuery(requests[end].type)) {
+            ++end;
+        }
+        executor_.ParallelFor(end - begin,
+            [this, &requests, &responses, begin](size_t i)
+            {
+                Execute(requests[begin + i], responses[begin + i]);
+            });
+        begin = end;
+    }
+    for (const std::string& response : responses) {
+        connection.output += response;
+    }
+    // Requests point into the input, so it is trimmed only now
+    connection.input.erase(0, consumed);
+}
+
+void NetworkServer::Execute(const Request& request, std::string& out) {
+    try {
+        switch (request.type) {
+        case RequestType::FIND_TOP_DOCUMENTS:
+            EncodeDocumentsResponse(request.request_id,
+                search_server_.FindTopDocuments(executor_, request.text, request.status, request.top_k), out);
+            break;
+        case RequestType::MATCH_DOCUMENT: {
+            const auto [words, status] = search_server_.MatchDocument(request.text, request.document_id);
+            EncodeMatchResponse(request.request_id, words, status, out);
+            break;
+        }
+        case RequestType::ADD_DOCUMENT:
+            search_server_.AddDocument(request.document_id, request.text, request.status, request.ratings);
+            EncodeEmptyResponse(request.request_id, out);
+            break;
+        case RequestType::REMOVE_DOCUMENT:
+            search_server_.RemoveDocument(request.document_id);
+            EncodeEmptyResponse(request.request_id, out);
+            break;
+        }
+    }
+    catch (const std::exception& error) {
+        out.clear();
+        EncodeErrorResponse(request.request_id, error.what(), out);
+    }
+}
+
+void NetworkServer::UpdateEvents(Connection& connection) {
+    const bool has_output = !connection.output.empty();
+    const bool is_reading = connection.output.size() - connection.output_offset < MAX_PENDING_OUTPUT;
+    epoll_event event{};
+    event.events = (is_reading ? static_cast<uint32_t>(EPOLLIN) : 0u) | (has_output ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    event.data.fd = connection.fd;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, connection.fd, &event);
+}
+
+void NetworkServer::Close(int fd) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections_.erase(fd);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "query_executor.h"
+#include "query_protocol.h"
+#include "search_server.h"
+
+// Serves a SearchServer over TCP and Unix stream sockets with one epoll
+// event loop. Clients may pipeline requests: every complete frame of a read
+// is decoded, runs of consecutive queries are executed in parallel on a
+// QueryExecutor while updates run alone between them, and the responses of
+// the whole batch go out in one write, in request order.
+class NetworkServer {
+public:
+    explicit NetworkServer(SearchServer& search_server, size_t worker_count = std::thread::hardware_concurrency());
+    NetworkServer(const NetworkServer&) = delete;
+    NetworkServer& operator=(const NetworkServer&) = delete;
+    ~NetworkServer();
+
+    // Port 0 binds a free port; returns the bound one
+    uint16_t ListenTcp(const std::string& address, uint16_t port);
+    void ListenUnix(const std::string& path);
+
+    // Serves connections until Stop is called
+    void Run();
+    // Safe to call from any thread and from a signal handler
+    void Stop();
+
+private:
+    // A connection stops reading while this much output waits for the client
+    static constexpr size_t MAX_PENDING_OUTPUT = 4 << 20;
+    static constexpr size_t READ_CHUNK_SIZE = 64 << 10;
+    // Reading stops once a batch is this large, so it must hold the largest
+    // frame or a frame over it would never complete
+    static constexpr size_t MAX_BATCH_INPUT = FRAME_HEADER_SIZE + MAX_FRAME_SIZE;
+
+    struct Connection {
+        int fd;
+        std::string input;
+        std::string output;
+        size_t output_offset = 0;
+    };
+
+    SearchServer& search_server_;
+    QueryExecutor executor_;
+    int epoll_fd_ = -1;
+    int stop_fd_ = -1;
+    std::vector<int> listen_fds_;
+    std::vector<std::string> unix_paths_;
+    std::unordered_map<int, std::unique_ptr<Connection>> connections_;
+
+    void AddListener(int fd);
+    void Accept(int listen_fd);
+    // Return false once the connection has to be closed
+    bool ReadFrom(Connection& connection);
+    bool WriteTo(Connection& connection);
+    void ProcessRequests(Connection& connection);
+    void Execute(const Request& request, std::string& out);
+    void UpdateEvents(Connection& connection);
+    void Close(int fd);
+};
@@ -0,0 +1,97 @@
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "network_server.h"
+#include "search_server.h"
+
+using namespace std::literals;
+
+// Standalone query server:
+//   network_server_main [--tcp ADDRESS:PORT] [--unix PATH]
+//                       [--stop-words "WORDS"] [--snapshot PATH] [--threads N]
+// Serves until SIGINT or SIGTERM.
+
+namespace {
+
+NetworkServer* running_server = nullptr;
+
+void HandleStopSignal(int) {
+    if (running_server != nullptr) {
+        running_server->Stop();
+    }
+}
+
+int PrintUsage() {
+    std::cerr << "usage: network_server_main [--tcp ADDRESS:PORT] [--unix PATH] [--stop-words WORDS] [--snapshot PATH] [--threads N]"s << std::endl;
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::optional<std::string> tcp_endpoint;
+    std::optional<std::string> unix_path;
+    std::optional<std::string> snapshot_path;
+    std::string stop_words;
+    size_t thread_count = std::thread::hardware_concurrency();
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view option = argv[i];
+        if (i + 1 == argc) {
+            return PrintUsage();
+        }
+        const std::string value = argv[++i];
+        if (option == "--tcp"sv) {
+            tcp_endpoint = value;
+        }
+        else if (option == "--unix"sv) {
+            unix_path = value;
+        }
+        else if (option == "--stop-words"sv) {
+            stop_words = value;
+        }
+        else if (option == "--snapshot"sv) {
+            snapshot_path = value;
+        }
+        else if (option == "--threads"sv) {
+            thread_count = std::strtoul(value.c_str(), nullptr, 10);
+        }
+        else {
+            return PrintUsage();
+        }
+    }
+    if (!tcp_endpoint && !unix_path) {
+        return PrintUsage();
+    }
+
+    try {
+        SearchServer search_server = snapshot_path ? SearchServer::OpenSnapshot(*snapshot_path) : SearchServer(stop_words);
+        NetworkServer network_server(search_server, thread_count);
+        if (tcp_endpoint) {
+            const size_t colon = tcp_endpoint->rfind(':');
+            if (colon == std::string::npos) {
+                return PrintUsage();
+            }
+            const uint16_t port = network_server.ListenTcp(tcp_endpoint->substr(0, colon),
+                static_cast<uint16_t>(std::strtoul(tcp_endpoint->c_str() + colon + 1, nullptr, 10)));
+            std::cerr << "listening on "s << tcp_endpoint->substr(0, colon) << ':' << port << std::endl;
+        }
+        if (unix_path) {
+            network_server.ListenUnix(*unix_path);
+            std::cerr << "listening on "s << *unix_path << std::endl;
+        }
+        running_server = &network_server;
+        std::signal(SIGINT, HandleStopSignal);
+        std::signal(SIGTERM, HandleStopSignal);
+        network_server.Run();
+        running_server = nullptr;
+    }
+    catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
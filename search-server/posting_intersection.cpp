@@ -0,0 +1,106 @@
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "posting_intersection.h"
+
+namespace {
+
+// A list this many times longer than the ordinals left is sought through
+const size_t SEEK_RATIO = 16;
+
+size_t IntersectSeeking(const int* lhs, size_t lhs_size, const PostingList& rhs, int* out) {
+    size_t count = 0;
+    PostingList::Cursor cursor(rhs);
+    for (size_t i = 0; i < lhs_size; ++i) {
+        cursor.Seek(lhs[i]);
+        if (cursor.IsAtEnd()) {
+            break;
+        }
+        if (cursor.GetDocumentId() == lhs[i]) {
+            out[count++] = lhs[i];
+        }
+    }
+    return count;
+}
+
+// Both sides advance four ordinals at a time: every ordinal of the lhs
+// block is compared with all four of the rhs block, and the block ending
+// lower is moved past. Ordinals are strictly increasing, so two equal ones
+// are always loaded together at some step.
+size_t IntersectMerging(const int* lhs, size_t lhs_size, const int* rhs, size_t rhs_size, int* out) {
+    size_t count = 0;
+    size_t i = 0;
+    size_t j = 0;
+#if defined(__SSE2__)
+    while (i + 4 <= lhs_size && j + 4 <= rhs_size) {
+        const __m128i lhs_block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+        const __m128i rhs_block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + j));
+        const __m128i equal = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(lhs_block, rhs_block),
+                _mm_cmpeq_epi32(lhs_block, _mm_shuffle_epi32(rhs_block, _MM_SHUFFLE(0, 3, 2, 1)))),
+            _mm_or_si128(_mm_cmpeq_epi32(lhs_block, _mm_shuffle_epi32(rhs_block, _MM_SHUFFLE(1, 0, 3, 2))),
+                _mm_cmpeq_epi32(lhs_block, _mm_shuffle_epi32(rhs_block, _MM_SHUFFLE(2, 1, 0, 3)))));
+        const int mask = _mm_movemask_ps(_mm_castsi128_ps(equal));
+        for (int lane = 0; lane < 4; ++lane) {
+            if (mask & (1 << lane)) {
+                out[count++] = lhs[i + lane];
+            }
+        }
+        const int lhs_last = lhs[i + 3];
+        const int rhs_last = rhs[j + 3];
+        if (lhs_last <= rhs_last) {
+            i += 4;
+        }
+        if (rhs_last <= lhs_last) {
+            j += 4;
+        }
+    }
+#endif
+    while (i < lhs_size && j < rhs_size) {
+        if (lhs[i] < rhs[j]) {
+            ++i;
+        }
+        else if (rhs[j] < lhs[i]) {
+            ++j;
+        }
+        else {
+            out[count++] = lhs[i];
+            ++i;
+            ++j;
+        }
+    }
+    return count;
+}
+
+size_t Intersect(const int* lhs, size_t lhs_size, const PostingList& rhs, std::vector<int>& buffer, int* out) {
+    if (rhs.size() / SEEK_RATIO > lhs_size) {
+        return IntersectSeeking(lhs, lhs_size, rhs, out);
+    }
+    const std::vector<int>& ordinals = rhs.ReadDocumentIds(buffer);
+    return IntersectMerging(lhs, lhs_size, ordinals.data(), ordinals.size(), out);
+}
+
+} // namespace
+
+void IntersectPostingLists(std::vector<const PostingList*> lists, std::vector<int>& result) {
+    result.clear();
+    if (lists.empty()) {
+        return;
+    }
+    std::sort(lists.begin(), lists.end(),
+        [](const PostingList* lhs, const PostingList* rhs) {
+            return lhs->size() < rhs->size();
+        });
+    // Ordinals of the shortest list, narrowed by every further one
+    std::vector<int> buffer;
+    result = lists.front()->ReadDocumentIds(buffer);
+    std::vector<int> narrowed;
+    for (size_t i = 1; i < lists.size() && !result.empty(); ++i) {
+        narrowed.resize(result.size());
+        narrowed.resize(Intersect(result.data(), result.size(), *lists[i], buffer, narrowed.data()));
+        result.swap(narrowed);
+    }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "posting_list.h"
+
+// Ordinals present in every list, in increasing order. Lists are taken
+// shortest first and the ordinals left are matched against the next list:
+// by seeking a cursor through it when it is much longer, so the cost follows
+// the rarest list and the blocks passed over are not decoded, otherwise by a
+// merge that compares four ordinals of each side at once.
+void IntersectPostingLists(std::vector<const PostingList*> lists, std::vector<int>& result);
@@ -0,0 +1,491 @@
+#include <algorithm>
+
+#include "posting_list.h"
+
+namespace {
+
+// Packs `count` values at the width of the widest one, lowest bits first,
+// onto the end of `packed`; returns the width
+uint8_t PackValues(const uint32_t* values, size_t count, std::vector<uint32_t>& packed) {
+    uint32_t all_bits = 0;
+    for (size_t i = 0; i < count; ++i) {
+        all_bits |= values[i];
+    }
+    uint8_t bits = 0;
+    while (bits < 32 && (all_bits >> bits) != 0) {
+        ++bits;
+    }
+    if (bits == 0) {
+        return 0;
+    }
+    const size_t first = packed.size();
+    packed.resize(first + (count * bits + 31) / 32, 0);
+    for (size_t i = 0; i < count; ++i) {
+        const size_t bit = i * bits;
+        const size_t word = first + bit / 32;
+        const size_t shift = bit % 32;
+        packed[word] |= values[i] << shift;
+        if (shift + bits > 32) {
+            packed[word + 1] |= values[i] >> (32 - shift);
+        }
+    }
+    return bits;
+}
+
+// PostingList::UnpackValue for one width, so that the shifts and the mask
+// are constants
+template <size_t BITS>
+uint32_t UnpackValue(const uint32_t* packed, size_t index) {
+    constexpr uint64_t MASK = (uint64_t{ 1 } << BITS) - 1;
+    const size_t bit = index * BITS;
+    return static_cast<uint32_t>(((packed[bit / 32] | (uint64_t{ packed[bit / 32 + 1] } << 32)) >> (bit % 32)) & MASK);
+}
+
+// 32 values take exactly BITS words; with every index a constant, each
+// value is two loads, a shift and a mask
+template <size_t BITS, size_t... INDEXES>
+void UnpackGroup(const uint32_t* packed, uint32_t* values, std::index_sequence<INDEXES...>) {
+    ((values[INDEXES] = UnpackValue<BITS>(packed, INDEXES)), ...);
+}
+
+// Unpacks `count` values of one width, whole groups first
+template <size_t BITS>
+void UnpackValues(const uint32_t* packed, size_t count, uint32_t* values) {
+    if constexpr (BITS == 0) {
+        std::fill(values, values + count, 0u);
+    }
+    else {
+        size_t i = 0;
+        for (; i + 32 <= count; i += 32) {
+            UnpackGroup<BITS>(packed + i / 32 * BITS, values + i, std::make_index_sequence<32>());
+        }
+        for (; i < count; ++i) {
+            values[i] = UnpackValue<BITS>(packed, i);
+        }
+    }
+}
+
+using Unpacker = void (*)(const uint32_t* packed, size_t count, uint32_t* values);
+
+template <size_t... BITS>
+constexpr std::array<Unpacker, sizeof...(BITS)> MakeUnpackers(std::index_sequence<BITS...>) {
+    return { &UnpackValues<BITS>... };
+}
+
+// Indexed by the width, 0 to 32 bits
+constexpr std::array<Unpacker, 33> UNPACKERS = MakeUnpackers(std::make_index_sequence<33>());
+
+size_t GetPackedWordCount(size_t count, uint8_t bits) {
+    return (count * bits + 31) / 32;
+}
+
+} // namespace
+
+PostingList::Cursor::Cursor(const PostingList& postings, size_t position)
+    :postings_(&postings), document_ids_(postings.document_ids_.data()), size_(postings.document_ids_.size()), position_(position),
+    term_freqs_(postings.is_compressed_ ? nullptr : postings.term_freqs_.data())
+{
+    if (!postings.is_compressed_) {
+        position_ = std::min(position, size_);
+    }
+    else if (position >= postings.compressed_size_) {
+        MoveToEnd();
+    }
+    else {
+        LoadBlock(position / BLOCK_SIZE);
+        position_ = position % BLOCK_SIZE;
+    }
+}
+
+PostingList::Cursor::Cursor(const Cursor& other)
+    :postings_(other.postings_), document_ids_(other.document_ids_), size_(other.size_), position_(other.position_),
+    term_freqs_(other.term_freqs_), term_freq_indexes_(other.term_freq_indexes_), term_freq_bits_(other.term_freq_bits_), block_(other.block_)
+{
+    // A compressed list is read from the copied block, not the other cursor's
+    if (postings_->is_compressed_) {
+        std::copy(other.block_document_ids_.begin(), other.block_document_ids_.begin() + size_, block_document_ids_.begin());
+        document_ids_ = block_document_ids_.data();
+    }
+}
+
+PostingList::Cursor& PostingList::Cursor::operator=(const Cursor& other) {
+    if (this != &other) {
+        postings_ = other.postings_;
+        document_ids_ = other.document_ids_;
+        size_ = other.size_;
+        position_ = other.position_;
+        term_freqs_ = other.term_freqs_;
+        term_freq_indexes_ = other.term_freq_indexes_;
+        term_freq_bits_ = other.term_freq_bits_;
+        block_ = other.block_;
+        if (postings_->is_compressed_) {
+            std::copy(other.block_document_ids_.begin(), other.block_document_ids_.begin() + size_, block_document_ids_.begin());
+            document_ids_ = block_document_ids_.data();
+        }
+    }
+    return *this;
+}
+
+size_t PostingList::Cursor::GetPosition() const {
+    return postings_->is_compressed_ ? block_ * BLOCK_SIZE + position_ : position_;
+}
+
+void PostingList::Cursor::Seek(int document_id) {
+    if (IsAtEnd() || document_ids_[position_] >= document_id) {
+        return;
+    }
+    if (!postings_->is_compressed_) {
+        const size_t block = postings_->FindBlock(position_ / BLOCK_SIZE, document_id);
+        if (block == postings_->blocks_.size()) {
+            position_ = size_;
+            return;
+        }
+        const int* first = document_ids_ + std::max(position_, block * BLOCK_SIZE);
+        const int* last = document_ids_ + std::min(size_, (block + 1) * BLOCK_SIZE);
+        position_ = std::lower_bound(first, last, document_id) - document_ids_;
+        return;
+    }
+    const size_t block = postings_->FindBlock(block_, document_id);
+    if (block == postings_->blocks_.size()) {
+        MoveToEnd();
+        return;
+    }
+    if (block != block_) {
+        LoadBlock(block);
+    }
+    position_ = std::lower_bound(document_ids_ + position_, document_ids_ + size_, document_id) - document_ids_;
+}
+
+void PostingList::Cursor::LoadBlock(size_t block) {
+    block_ = block;
+    size_ = postings_->DecodeBlock(block, block_document_ids_.data());
+    position_ = 0;
+    document_ids_ = block_document_ids_.data();
+    term_freq_indexes_ = postings_->GetTermFreqIndexes(block);
+    term_freq_bits_ = postings_->blocks_[block].term_freq_bits;
+}
+
+void PostingList::Cursor::MoveToEnd() {
+    if (!postings_->is_compressed_) {
+        position_ = size_;
+        return;
+    }
+    // The end is past the last posting of the last block; nothing is read there
+    block_ = postings_->blocks_.size() - 1;
+    size_ = postings_->GetBlockSize(block_);
+    position_ = size_;
+    document_ids_ = block_document_ids_.data();
+}
+
+PostingList::ConstIterator::ConstIterator(const PostingList* list, size_t position)
+    :list_(list), cursor_(*list, position)
+{}
+
+PostingList::ConstIterator::value_type PostingList::ConstIterator::operator*() const {
+    return { cursor_.GetDocumentId(), cursor_.GetTermFreq() };
+}
+
+PostingList::ConstIterator& PostingList::ConstIterator::operator++() {
+    cursor_.Next();
+    return *this;
+}
+
+PostingList::ConstIterator PostingList::ConstIterator::operator++(int) {
+    ConstIterator previous = *this;
+    cursor_.Next();
+    return previous;
+}
+
+bool PostingList::ConstIterator::operator==(const ConstIterator& other) const {
+    return list_ == other.list_ && cursor_.GetPosition() == other.cursor_.GetPosition();
+}
+
+bool PostingList::ConstIterator::operator!=(const ConstIterator& other) const {
+    return !(*this == other);
+}
+
+void PostingList::Add(int document_id, double term_freq) {
+    Decompress();
+    // Documents normally arrive in increasing id order, so this is an append
+    if (document_ids_.empty() || document_ids_.back() < document_id) {
+        document_ids_.push_back(document_id);
+        term_freqs_.push_back(term_freq);
+        max_term_freq_ = std::max(max_term_freq_, term_freq);
+        if (document_ids_.size() % BLOCK_SIZE == 1) {
+            blocks_.push_back({ document_id, term_freq });
+        }
+        else {
+            blocks_.back().last_document_id = document_id;
+            blocks_.back().max_term_freq = std::max(blocks_.back().max_term_freq, term_freq);
+        }
+        return;
+    }
+    const size_t position = LowerBound(document_id);
+    if (document_ids_[position] == document_id) {
+        term_freqs_[position] += term_freq;
+        max_term_freq_ = std::max(max_term_freq_, term_freqs_[position]);
+        Block& block = blocks_[position / BLOCK_SIZE];
+        block.max_term_freq = std::max(block.max_term_freq, term_freqs_[position]);
+        return;
+    }
+    document_ids_.insert(document_ids_.begin() + position, document_id);
+    term_freqs_.insert(term_freqs_.begin() + position, term_freq);
+    max_term_freq_ = std::max(max_term_freq_, term_freq);
+    RebuildBlocks(position / BLOCK_SIZE);
+}
+
+void PostingList::Assign(const int* document_ids, const double* term_freqs, size_t count) {
+    Decompress();
+    document_ids_.assign(document_ids, document_ids + count);
+    term_freqs_.assign(term_freqs, term_freqs + count);
+    max_term_freq_ = count == 0 ? 0.0 : *std::max_element(term_freqs_.begin(), term_freqs_.end());
+    RebuildBlocks(0);
+}
+
+void PostingList::Append(const PostingList& other) {
+    Decompress();
+    const size_t first_block = document_ids_.size() / BLOCK_SIZE;
+    document_ids_.reserve(document_ids_.size() + other.size());
+    term_freqs_.reserve(term_freqs_.size() + other.size());
+    for (Cursor cursor(other); !cursor.IsAtEnd(); cursor.Next()) {
+        document_ids_.push_back(cursor.GetDocumentId());
+        term_freqs_.push_back(cursor.GetTermFreq());
+    }
+    max_term_freq_ = std::max(max_term_freq_, other.max_term_freq_);
+    RebuildBlocks(first_block);
+}
+
+bool PostingList::Erase(int document_id) {
+    Decompress();
+    const size_t position = LowerBound(document_id);
+    if (position == document_ids_.size() || document_ids_[position] != document_id) {
+        return false;
+    }
+    document_ids_.erase(document_ids_.begin() + position);
+    term_freqs_.erase(term_freqs_.begin() + position);
+    RebuildBlocks(position / BLOCK_SIZE);
+    return true;
+}
+
+void PostingList::RemapDocumentIds(const std::vector<int>& new_document_ids) {
+    Decompress();
+    for (int& document_id : document_ids_) {
+        document_id = new_document_ids[document_id];
+    }
+    // Only the last document id of every block changes
+    for (size_t block = 0; block < blocks_.size(); ++block) {
+        blocks_[block].last_document_id = document_ids_[std::min(document_ids_.size(), (block + 1) * BLOCK_SIZE) - 1];
+    }
+}
+
+void PostingList::Compress() {
+    if (is_compressed_ || document_ids_.size() < BLOCK_SIZE) {
+        return;
+    }
+    term_freq_values_ = term_freqs_;
+    std::sort(term_freq_values_.begin(), term_freq_values_.end());
+    term_freq_values_.erase(std::unique(term_freq_values_.begin(), term_freq_values_.end()), term_freq_values_.end());
+    term_freq_values_.shrink_to_fit();
+
+    packed_.clear();
+    std::array<uint32_t, BLOCK_SIZE> values;
+    int previous_document_id = -1;
+    for (size_t block = 0; block < blocks_.size(); ++block) {
+        const size_t begin = block * BLOCK_SIZE;
+        const size_t count = std::min(document_ids_.size() - begin, BLOCK_SIZE);
+        // Ids are increasing, so every gap is stored less one
+        for (size_t i = 0; i < count; ++i) {
+            values[i] = static_cast<uint32_t>(document_ids_[begin + i] - previous_document_id - 1);
+            previous_document_id = document_ids_[begin + i];
+        }
+        blocks_[block].offset = static_cast<uint32_t>(packed_.size());
+        blocks_[block].document_id_bits = PackValues(values.data(), count, packed_);
+        for (size_t i = 0; i < count; ++i) {
+            values[i] = static_cast<uint32_t>(std::lower_bound(term_freq_values_.begin(), term_freq_values_.end(), term_freqs_[begin + i])
+                - term_freq_values_.begin());
+        }
+        blocks_[block].term_freq_bits = PackValues(values.data(), count, packed_);
+    }
+    packed_.push_back(0);
+    packed_.shrink_to_fit();
+    blocks_.shrink_to_fit();
+
+    compressed_size_ = document_ids_.size();
+    std::vector<int>().swap(document_ids_);
+    std::vector<double>().swap(term_freqs_);
+    is_compressed_ = true;
+}
+
+bool PostingList::IsCompressed() const {
+    return is_compressed_;
+}
+
+size_t PostingList::GetMemoryUsage() const {
+    return document_ids_.capacity() * sizeof(int) + term_freqs_.capacity() * sizeof(double) + blocks_.capacity() * sizeof(Block)
+        + packed_.capacity() * sizeof(uint32_t) + term_freq_values_.capacity() * sizeof(double);
+}
+
+bool PostingList::Contains(int document_id) const {
+    if (is_compressed_) {
+        const size_t block = FindBlock(0, document_id);
+        if (block == blocks_.size()) {
+            return false;
+        }
+        return FindInBlock(block, document_id) < GetBlockSize(block);
+    }
+    const size_t position = LowerBound(document_id);
+    return position != document_ids_.size() && document_ids_[position] == document_id;
+}
+
+double PostingList::GetTermFreq(int document_id) const {
+    if (is_compressed_) {
+        const size_t block = FindBlock(0, document_id);
+        if (block == blocks_.size()) {
+            return 0.0;
+        }
+        const size_t position = FindInBlock(block, document_id);
+        if (position == GetBlockSize(block)) {
+            return 0.0;
+        }
+        return term_freq_values_[UnpackValue(GetTermFreqIndexes(block), position, blocks_[block].term_freq_bits)];
+    }
+    const size_t position = LowerBound(document_id);
+    if (position == document_ids_.size() || document_ids_[position] != document_id) {
+        return 0.0;
+    }
+    return term_freqs_[position];
+}
+
+double PostingList::GetMaxTermFreq() const {
+    return max_term_freq_;
+}
+
+size_t PostingList::FindBlock(size_t block, int document_id) const {
+    if (block >= blocks_.size() || blocks_[block].last_document_id >= document_id) {
+        return block;
+    }
+    // Doubles the step while whole blocks end before document_id, then
+    // searches the last step
+    size_t step = 1;
+    while (block + step < blocks_.size() && blocks_[block + step].last_document_id < document_id) {
+        block += step;
+        step *= 2;
+    }
+    const auto first = blocks_.begin() + block + 1;
+    const auto last = blocks_.begin() + std::min(blocks_.size(), block + step);
+    return std::partition_point(first, last,
+        [document_id](const Block& block) {
+            return block.last_document_id < document_id;
+        }) - blocks_.begin();
+}
+
+size_t PostingList::size() const {
+    return is_compressed_ ? compressed_size_ : document_ids_.size();
+}
+
+bool PostingList::empty() const {
+    return size() == 0;
+}
+
+void PostingList::Reserve(size_t capacity) {
+    Decompress();
+    document_ids_.reserve(capacity);
+    term_freqs_.reserve(capacity);
+}
+
+void PostingList::ShrinkToFit() {
+    document_ids_.shrink_to_fit();
+    term_freqs_.shrink_to_fit();
+    blocks_.shrink_to_fit();
+}
+
+const std::vector<int>& PostingList::ReadDocumentIds(std::vector<int>& buffer) const {
+    if (!is_compressed_) {
+        return document_ids_;
+    }
+    buffer.resize(compressed_size_);
+    for (size_t block = 0; block < blocks_.size(); ++block) {
+        DecodeBlock(block, buffer.data() + block * BLOCK_SIZE);
+    }
+    return buffer;
+}
+
+const std::vector<PostingList::Block>& PostingList::GetBlocks() const {
+    return blocks_;
+}
+
+PostingList::ConstIterator PostingList::begin() const {
+    return { this, 0 };
+}
+
+PostingList::ConstIterator PostingList::end() const {
+    return { this, size() };
+}
+
+size_t PostingList::LowerBound(int document_id) const {
+    return std::lower_bound(document_ids_.begin(), document_ids_.end(), document_id) - document_ids_.begin();
+}
+
+void PostingList::RebuildBlocks(size_t first_block) {
+    blocks_.resize(first_block);
+    for (size_t begin = first_block * BLOCK_SIZE; begin < document_ids_.size(); begin += BLOCK_SIZE) {
+        const size_t end = std::min(document_ids_.size(), begin + BLOCK_SIZE);
+        blocks_.push_back({ document_ids_[end - 1], *std::max_element(term_freqs_.begin() + begin, term_freqs_.begin() + end) });
+    }
+}
+
+size_t PostingList::DecodeBlock(size_t block, int* document_ids) const {
+    const size_t count = GetBlockSize(block);
+    std::array<uint32_t, BLOCK_SIZE> values;
+    UNPACKERS[blocks_[block].document_id_bits](packed_.data() + blocks_[block].offset, count, values.data());
+    int document_id = block == 0 ? -1 : blocks_[block - 1].last_document_id;
+    for (size_t i = 0; i < count; ++i) {
+        document_id += static_cast<int>(values[i]) + 1;
+        document_ids[i] = document_id;
+    }
+    return count;
+}
+
+size_t PostingList::FindInBlock(size_t block, int document_id) const {
+    const size_t count = GetBlockSize(block);
+    const uint32_t* packed = packed_.data() + blocks_[block].offset;
+    const uint8_t bits = blocks_[block].document_id_bits;
+    int current_id = block == 0 ? -1 : blocks_[block - 1].last_document_id;
+    for (size_t position = 0; position < count; ++position) {
+        current_id += static_cast<int>(UnpackValue(packed, position, bits)) + 1;
+        if (current_id >= document_id) {
+            return current_id == document_id ? position : count;
+        }
+    }
+    return count;
+}
+
+const uint32_t* PostingList::GetTermFreqIndexes(size_t block) const {
+    return packed_.data() + blocks_[block].offset + GetPackedWordCount(GetBlockSize(block), blocks_[block].document_id_bits);
+}
+
+size_t PostingList::GetBlockSize(size_t block) const {
+    return std::min(size() - block * BLOCK_SIZE, BLOCK_SIZE);
+}
+
+void PostingList::Decompress() {
+    if (!is_compressed_) {
+        return;
+    }
+    document_ids_.resize(compressed_size_);
+    term_freqs_.resize(compressed_size_);
+    for (size_t block = 0; block < blocks_.size(); ++block) {
+        const size_t count = DecodeBlock(block, document_ids_.data() + block * BLOCK_SIZE);
+        const uint32_t* term_freq_indexes = GetTermFreqIndexes(block);
+        for (size_t position = 0; position < count; ++position) {
+            term_freqs_[block * BLOCK_SIZE + position] = term_freq_values_[UnpackValue(term_freq_indexes, position, blocks_[block].term_freq_bits)];
+        }
+        blocks_[block].offset = 0;
+        blocks_[block].document_id_bits = 0;
+        blocks_[block].term_freq_bits = 0;
+    }
+    std::vector<uint32_t>().swap(packed_);
+    std::vector<double>().swap(term_freq_values_);
+    compressed_size_ = 0;
+    is_compressed_ = false;
+}
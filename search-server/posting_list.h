@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+// Contiguous posting list: document ids kept sorted in one array,
+// term frequencies stored in a parallel array at the same positions.
+// Postings are grouped into fixed-size blocks whose last document id and
+// max term frequency let readers skip a block without touching it.
+//
+// Lists of sealed segments are compressed: within a block the gaps between
+// document ids are bit-packed at the smallest width that fits them, and
+// term frequencies become bit-packed indexes into a table of the distinct
+// values of the list, so no score changes. Such lists are read through a
+// Cursor, which decodes one block at a time; modifying one decompresses it.
+class PostingList {
+public:
+    static constexpr size_t BLOCK_SIZE = 128;
+
+    struct Block {
+        int last_document_id;
+        double max_term_freq;
+        // Start of the block's packed words in a compressed list, and the
+        // widths of its id gaps and term frequency indexes
+        uint32_t offset = 0;
+        uint8_t document_id_bits = 0;
+        uint8_t term_freq_bits = 0;
+    };
+
+    // Reads the list in document id order. A plain list is read in place,
+    // a compressed one is decoded into the cursor a block at a time.
+    class Cursor {
+    public:
+        // Positioned at the posting with this index, or at the end for size()
+        explicit Cursor(const PostingList& postings, size_t position = 0);
+        Cursor(const Cursor& other);
+        Cursor& operator=(const Cursor& other);
+
+        bool IsAtEnd() const;
+        int GetDocumentId() const;
+        // Term frequencies of a compressed list are decoded one at a time,
+        // as most postings a query passes are never scored
+        double GetTermFreq() const;
+        // Index of the posting in the list, size() at the end
+        size_t GetPosition() const;
+
+        void Next();
+        // Moves forward to the first posting whose document id is not less
+        // than document_id; blocks ending before it are not decoded
+        void Seek(int document_id);
+
+    private:
+        const PostingList* postings_;
+        // Document ids of the block the cursor is in, or of the whole list
+        // when it is plain
+        const int* document_ids_;
+        size_t size_;
+        size_t position_;
+        // Term frequencies of a plain list, or nullptr and the packed
+        // indexes of the block
+        const double* term_freqs_;
+        const uint32_t* term_freq_indexes_ = nullptr;
+        uint8_t term_freq_bits_ = 0;
+        size_t block_ = 0;
+        std::array<int, BLOCK_SIZE> block_document_ids_;
+
+        void LoadBlock(size_t block);
+        void MoveToEnd();
+    };
+
+    // Dereferencing builds the pair from the cursor, so there is no element
+    // to refer to and the iterator is only an input iterator
+    class ConstIterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::pair<int, double>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+        ConstIterator(const PostingList* list, size_t position);
+
+        value_type operator*() const;
+        ConstIterator& operator++();
+        ConstIterator operator++(int);
+        bool operator==(const ConstIterator& other) const;
+        bool operator!=(const ConstIterator& other) const;
+
+    private:
+        const PostingList* list_;
+        Cursor cursor_;
+    };
+
+    void Add(int document_id, double term_freq);
+    // Replaces the contents with `count` postings already sorted by document id
+    void Assign(const int* document_ids, const double* term_freqs, size_t count);
+    // Appends postings of `other`, all of whose document ids must be greater
+    void Append(const PostingList& other);
+    bool Erase(int document_id);
+    // Erases the postings whose document id satisfies the predicate in one
+    // pass and recomputes the bounds; returns the number of erased postings
+    template <typename Predicate>
+    size_t EraseIf(Predicate predicate);
+    // Replaces every document id with new_document_ids[document_id]; the
+    // mapping must be increasing over the ids in the list
+    void RemapDocumentIds(const std::vector<int>& new_document_ids);
+
+    // Lists shorter than a block stay plain, their block header and value
+    // table would outweigh the savings
+    void Compress();
+    bool IsCompressed() const;
+    // Bytes held by the postings and their block headers
+    size_t GetMemoryUsage() const;
+
+    bool Contains(int document_id) const;
+    double GetTermFreq(int document_id) const;
+    // Upper bound of the term frequencies in the list; it is not lowered
+    // when postings are erased
+    double GetMaxTermFreq() const;
+
+    // Index of the first block at or after `block` that may contain
+    // document_id, or the block count if there is none; gallops, so a
+    // cursor moved by few long jumps touches few block headers
+    size_t FindBlock(size_t block, int document_id) const;
+
+    size_t size() const;
+    bool empty() const;
+    void Reserve(size_t capacity);
+    void ShrinkToFit();
+
+    // Document ids of the whole list: the list's own array, or decoded into
+    // buffer when the list is compressed
+    const std::vector<int>& ReadDocumentIds(std::vector<int>& buffer) const;
+    const std::vector<Block>& GetBlocks() const;
+
+    ConstIterator begin() const;
+    ConstIterator end() const;
+
+private:
+    // Plain form; empty while the list is compressed
+    std::vector<int> document_ids_;
+    std::vector<double> term_freqs_;
+    std::vector<Block> blocks_;
+    double max_term_freq_ = 0.0;
+    // Compressed form: packed words of all blocks followed by a spare one,
+    // and the sorted distinct term frequencies the indexes refer to
+    std::vector<uint32_t> packed_;
+    std::vector<double> term_freq_values_;
+    size_t compressed_size_ = 0;
+    bool is_compressed_ = false;
+
+    size_t LowerBound(int document_id) const;
+    void RebuildBlocks(size_t first_block);
+    // Decodes the document ids of a block of a compressed list and returns their count
+    size_t DecodeBlock(size_t block, int* document_ids) const;
+    // Position of document_id in a block of a compressed list, or the block
+    // size; decoding stops at the first id not less than it
+    size_t FindInBlock(size_t block, int document_id) const;
+    const uint32_t* GetTermFreqIndexes(size_t block) const;
+    size_t GetBlockSize(size_t block) const;
+    void Decompress();
+
+    // Value `index` of a run packed at `bits` bits each; reads the word
+    // after the one holding it, which the spare word keeps in bounds
+    static uint32_t UnpackValue(const uint32_t* packed, size_t index, uint8_t bits);
+};
+
+template <typename Predicate>
+size_t PostingList::EraseIf(Predicate predicate) {
+    Decompress();
+    size_t kept = 0;
+    for (size_t position = 0; position < document_ids_.size(); ++position) {
+        if (!predicate(document_ids_[position])) {
+            document_ids_[kept] = document_ids_[position];
+            term_freqs_[kept] = term_freqs_[position];
+            ++kept;
+        }
+    }
+    const size_t erased = document_ids_.size() - kept;
+    if (erased > 0) {
+        document_ids_.resize(kept);
+        term_freqs_.resize(kept);
+        max_term_freq_ = term_freqs_.empty() ? 0.0 : *std::max_element(term_freqs_.begin(), term_freqs_.end());
+        RebuildBlocks(0);
+    }
+    return erased;
+}
+
+inline bool PostingList::Cursor::IsAtEnd() const {
+    return position_ == size_;
+}
+
+inline int PostingList::Cursor::GetDocumentId() const {
+    return document_ids_[position_];
+}
+
+inline double PostingList::Cursor::GetTermFreq() const {
+    if (term_freqs_ != nullptr) {
+        return term_freqs_[position_];
+    }
+    return postings_->term_freq_values_[UnpackValue(term_freq_indexes_, position_, term_freq_bits_)];
+}
+
+inline uint32_t PostingList::UnpackValue(const uint32_t* packed, size_t index, uint8_t bits) {
+    if (bits == 0) {
+        return 0;
+    }
+    const size_t bit = index * bits;
+    const uint64_t words = packed[bit / 32] | (uint64_t{ packed[bit / 32 + 1] } << 32);
+    return static_cast<uint32_t>((words >> (bit % 32)) & ((uint64_t{ 1 } << bits) - 1));
+}
+
+inline void PostingList::Cursor::Next() {
+    ++position_;
+    if (position_ == size_ && postings_->is_compressed_ && block_ + 1 < postings_->blocks_.size()) {
+        LoadBlock(block_ + 1);
+    }
+}
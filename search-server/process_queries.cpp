@@ -6,22 +6,48 @@
 
 #include "process_queries.h"
 
-std::vector<std::vector<Document>> ProcessQueries(const SearchServer& search_server, const std::vector<std::string>& queries) {
+namespace {
+
+QueryExecutor& GetDefaultExecutor() {
+	static QueryExecutor executor;
+	return executor;
+}
+
+template <typename Query>
+std::vector<std::vector<Document>> RunQueries(QueryExecutor& executor, const SearchServer& search_server, const std::vector<Query>& queries) {
 	std::vector<std::vector<Document>> result(queries.size());
-	std::transform(std::execution::par, queries.begin(), queries.end(), result.begin(),
-		[&search_server](std::string queri)
+	executor.ParallelFor(queries.size(),
+		[&executor, &search_server, &queries, &result](size_t i)
 		{
-			return search_server.FindTopDocuments(queri);
+			result[i] = search_server.FindTopDocuments(executor, queries[i]);
 		});
 
 
 	return result;
 }
 
+}
+
+std::vector<std::vector<Document>> ProcessQueries(const SearchServer& search_server, const std::vector<std::string>& queries) {
+	return RunQueries(GetDefaultExecutor(), search_server, queries);
+}
+
+std::vector<std::vector<Document>> ProcessQueries(QueryExecutor& executor, const SearchServer& search_server, const std::vector<std::string>& queries) {
+	return RunQueries(executor, search_server, queries);
+}
+
+std::vector<std::vector<Document>> ProcessQueries(const SearchServer& search_server, const std::vector<SearchServer::PreparedQuery>& queries) {
+	return RunQueries(GetDefaultExecutor(), search_server, queries);
+}
+
+std::vector<std::vector<Document>> ProcessQueries(QueryExecutor& executor, const SearchServer& search_server, const std::vector<SearchServer::PreparedQuery>& queries) {
+	return RunQueries(executor, search_server, queries);
+}
+
 std::vector<Document> ProcessQueriesJoined(const SearchServer& search_server, const std::vector<std::string>& queries)
 {
 	std::vector<Document> documents;
-	for (std::vector<Document> document : ProcessQueries(search_server, queries)) {
+	for (const std::vector<Document>& document : ProcessQueries(search_server, queries)) {
 		documents.insert(documents.end(), document.begin(), document.end());
 	}
 
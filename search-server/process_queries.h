@@ -1,7 +1,14 @@
 #pragma once
 
 #include "search_server.h"
+#include "query_executor.h"
 
 std::vector<std::vector<Document>> ProcessQueries(const SearchServer& search_server, const std::vector<std::string>& queries);
+// Runs the queries on the executor's workers; large queries are split
+// further on the same workers, so a few expensive ones do not hold up the batch
+std::vector<std::vector<Document>> ProcessQueries(QueryExecutor& executor, const SearchServer& search_server, const std::vector<std::string>& queries);
+// Same for queries prepared once with SearchServer::PrepareQuery
+std::vector<std::vector<Document>> ProcessQueries(const SearchServer& search_server, const std::vector<SearchServer::PreparedQuery>& queries);
+std::vector<std::vector<Document>> ProcessQueries(QueryExecutor& executor, const SearchServer& search_server, const std::vector<SearchServer::PreparedQuery>& queries);
 
-std::vector<Document> ProcessQueriesJoined(const SearchServer& search_server,const std::vector<std::string>& queries);
\ No newline at end of file
+std::vector<Document> ProcessQueriesJoined(const SearchServer& search_server,const std::vector<std::string>& queries);
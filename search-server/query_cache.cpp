@@ -0,0 +1,66 @@
+#include <functional>
+
+#include "query_cache.h"
+
+bool QueryCache::Key::operator==(const Key& other) const {
+    return plus_words == other.plus_words && minus_words == other.minus_words && required_words == other.required_words
+        && status == other.status && top_k == other.top_k;
+}
+
+size_t QueryCache::KeyHash::operator()(const Key& key) const {
+    size_t hash = std::hash<size_t>{}(key.top_k) * 31 + static_cast<size_t>(key.status);
+    for (const TermId word : key.plus_words) {
+        hash = hash * 1000003 + word;
+    }
+    // Keeps "a -b" and "a b" apart
+    hash = hash * 1000003 + key.plus_words.size();
+    for (const TermId word : key.minus_words) {
+        hash = hash * 1000003 + word;
+    }
+    hash = hash * 1000003 + key.minus_words.size();
+    for (const TermId word : key.required_words) {
+        hash = hash * 1000003 + word;
+    }
+    return hash;
+}
+
+QueryCache::QueryCache(size_t capacity)
+    :capacity_(capacity)
+{}
+
+std::optional<std::vector<Document>> QueryCache::Find(const Key& key, uint64_t generation) {
+    std::lock_guard guard(mutex_);
+    const auto it = index_.find(key);
+    if (it == index_.end() || it->second->generation != generation) {
+        ++stats_.miss_count;
+        return std::nullopt;
+    }
+    ++stats_.hit_count;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->documents;
+}
+
+void QueryCache::Insert(const Key& key, uint64_t generation, const std::vector<Document>& documents) {
+    if (capacity_ == 0) {
+        return;
+    }
+    std::lock_guard guard(mutex_);
+    const auto it = index_.find(key);
+    if (it != index_.end()) {
+        it->second->generation = generation;
+        it->second->documents = documents;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return;
+    }
+    if (entries_.size() == capacity_) {
+        index_.erase(entries_.back().key);
+        entries_.pop_back();
+    }
+    entries_.push_front({ key, generation, documents });
+    index_.emplace(key, entries_.begin());
+}
+
+QueryCacheStats QueryCache::GetStats() const {
+    std::lock_guard guard(mutex_);
+    return stats_;
+}
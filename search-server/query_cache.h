@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "document.h"
+#include "term_dictionary.h"
+
+struct QueryCacheStats {
+    uint64_t hit_count = 0;
+    uint64_t miss_count = 0;
+};
+
+// LRU cache of search results keyed by the parsed query. Entries remember
+// the index generation they were computed for; any update of the index
+// bumps the generation and turns every older entry into a miss.
+// All methods may be called from several threads at once.
+class QueryCache {
+public:
+    // Normalized query: deduplicated, sorted plus, minus and required words
+    struct Key {
+        std::vector<TermId> plus_words;
+        std::vector<TermId> minus_words;
+        std::vector<TermId> required_words;
+        DocumentStatus status;
+        size_t top_k;
+
+        bool operator==(const Key& other) const;
+    };
+
+    explicit QueryCache(size_t capacity);
+
+    std::optional<std::vector<Document>> Find(const Key& key, uint64_t generation);
+    void Insert(const Key& key, uint64_t generation, const std::vector<Document>& documents);
+    QueryCacheStats GetStats() const;
+
+private:
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+    struct Entry {
+        Key key;
+        uint64_t generation;
+        std::vector<Document> documents;
+    };
+
+    size_t capacity_;
+    mutable std::mutex mutex_;
+    // Most recently used entries at the front
+    std::list<Entry> entries_;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+    QueryCacheStats stats_;
+};
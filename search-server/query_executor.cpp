@@ -0,0 +1,94 @@
+#include "query_executor.h"
+
+namespace {
+    // Queue of the worker running on this thread, if any
+    thread_local const QueryExecutor* current_executor = nullptr;
+    thread_local size_t current_queue = 0;
+}
+
+    QueryExecutor::QueryExecutor(size_t worker_count) {
+        for (size_t i = 0; i <= worker_count; ++i) {
+            queues_.push_back(std::make_unique<WorkerQueue>());
+        }
+        for (size_t i = 0; i < worker_count; ++i) {
+            workers_.emplace_back([this, i]() {
+                WorkerLoop(i);
+            });
+        }
+    }
+
+    QueryExecutor::~QueryExecutor() {
+        {
+            std::lock_guard guard(sleep_mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    size_t QueryExecutor::GetWorkerCount() const {
+        return workers_.size();
+    }
+
+    size_t QueryExecutor::GetQueueIndex() const {
+        return current_executor == this ? current_queue : workers_.size();
+    }
+
+    void QueryExecutor::Push(Task task) {
+        WorkerQueue& queue = *queues_[GetQueueIndex()];
+        {
+            std::lock_guard guard(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        queued_.fetch_add(1);
+        {
+            std::lock_guard guard(sleep_mutex_);
+        }
+        wake_.notify_one();
+    }
+
+    bool QueryExecutor::RunTask() {
+        const size_t own = GetQueueIndex();
+        Task task;
+        {
+            WorkerQueue& queue = *queues_[own];
+            std::lock_guard guard(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+        }
+        for (size_t i = 1; !task && i < queues_.size(); ++i) {
+            WorkerQueue& queue = *queues_[(own + i) % queues_.size()];
+            std::lock_guard guard(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+        }
+        if (!task) {
+            return false;
+        }
+        queued_.fetch_sub(1);
+        task();
+        return true;
+    }
+
+    void QueryExecutor::WorkerLoop(size_t index) {
+        current_executor = this;
+        current_queue = index;
+        while (true) {
+            if (RunTask()) {
+                continue;
+            }
+            std::unique_lock lock(sleep_mutex_);
+            wake_.wait(lock, [this]() {
+                return stopping_.load() || queued_.load() > 0;
+            });
+            if (stopping_.load()) {
+                return;
+            }
+        }
+    }
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool for query batches. Every worker owns a deque:
+// it pushes and pops its own tasks at the back and, when it runs dry,
+// steals from the front of the others. ParallelFor splits its index range
+// in halves on demand, so the large halves are the ones stolen, and calls
+// nested inside a task (a big query scored in parallel inside a batch)
+// share the same workers instead of oversubscribing the machine.
+class QueryExecutor {
+public:
+    explicit QueryExecutor(size_t worker_count = std::thread::hardware_concurrency());
+    QueryExecutor(const QueryExecutor&) = delete;
+    QueryExecutor& operator=(const QueryExecutor&) = delete;
+    ~QueryExecutor();
+
+    // Calls func(i) for every i in [0, count) and returns once all calls
+    // have finished; the calling thread runs tasks while it waits. The
+    // first exception thrown by func is rethrown here.
+    template <typename Func>
+    void ParallelFor(size_t count, Func func);
+
+    size_t GetWorkerCount() const;
+
+private:
+    using Task = std::function<void()>;
+
+    struct alignas(64) WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    struct Job {
+        std::atomic<size_t> remaining;
+        std::mutex exception_mutex;
+        std::exception_ptr exception;
+    };
+
+    // One queue per worker and a last one shared by outside threads
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> queued_{ 0 };
+    std::atomic<bool> stopping_{ false };
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+
+    size_t GetQueueIndex() const;
+    void Push(Task task);
+    bool RunTask();
+    void WorkerLoop(size_t index);
+
+    template <typename Func>
+    void RunRange(Job& job, Func& func, size_t begin, size_t end);
+};
+
+template <typename Func>
+void QueryExecutor::ParallelFor(size_t count, Func func) {
+    if (count == 0) {
+        return;
+    }
+    Job job;
+    job.remaining = count;
+    RunRange(job, func, 0, count);
+    while (job.remaining.load() > 0) {
+        if (!RunTask()) {
+            std::this_thread::yield();
+        }
+    }
+    if (job.exception) {
+        std::rethrow_exception(job.exception);
+    }
+}
+
+template <typename Func>
+void QueryExecutor::RunRange(Job& job, Func& func, size_t begin, size_t end) {
+    // Keep the first index, offer the rest to thieves in shrinking halves
+    while (end - begin > 1) {
+        const size_t middle = begin + (end - begin) / 2;
+        Push([this, &job, &func, middle, end]() {
+            RunRange(job, func, middle, end);
+        });
+        end = middle;
+    }
+    try {
+        func(begin);
+    }
+    catch (...) {
+        std::lock_guard guard(job.exception_mutex);
+        if (!job.exception) {
+            job.exception = std::current_exception();
+        }
+    }
+    job.remaining.fetch_sub(1);
+}
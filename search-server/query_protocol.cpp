@@ -0,0 +1,270 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "query_protocol.h"
+
+using std::string_literals::operator""s;
+
+namespace {
+
+const uint8_t RESULT_OK = 0;
+const uint8_t RESULT_ERROR = 1;
+
+// Appends one frame; the length in its header is filled in by Finish
+class FrameWriter {
+public:
+    explicit FrameWriter(std::string& out)
+        :out_(out), start_(out.size())
+    {
+        out_.append(FRAME_HEADER_SIZE, '\0');
+    }
+
+    template <typename T>
+    void WriteInteger(T value) {
+        const uint64_t bits = static_cast<uint64_t>(value);
+        for (size_t byte = 0; byte < sizeof(T); ++byte) {
+            out_.push_back(static_cast<char>((bits >> (8 * byte)) & 0xFF));
+        }
+    }
+
+    void WriteDouble(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        WriteInteger(bits);
+    }
+
+    void WriteString(std::string_view text) {
+        WriteInteger(static_cast<uint32_t>(text.size()));
+        out_.append(text);
+    }
+
+    void Finish() {
+        const uint32_t size = static_cast<uint32_t>(out_.size() - start_ - FRAME_HEADER_SIZE);
+        for (size_t byte = 0; byte < FRAME_HEADER_SIZE; ++byte) {
+            out_[start_ + byte] = static_cast<char>((size >> (8 * byte)) & 0xFF);
+        }
+    }
+
+private:
+    std::string& out_;
+    size_t start_;
+};
+
+class PayloadReader {
+public:
+    explicit PayloadReader(std::string_view payload)
+        :payload_(payload)
+    {}
+
+    template <typename T>
+    T ReadInteger() {
+        const std::string_view bytes = Take(sizeof(T));
+        uint64_t bits = 0;
+        for (size_t byte = 0; byte < sizeof(T); ++byte) {
+            bits |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[byte])) << (8 * byte);
+        }
+        return static_cast<T>(bits);
+    }
+
+    double ReadDouble() {
+        const uint64_t bits = ReadInteger<uint64_t>();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    std::string_view ReadString() {
+        return Take(ReadInteger<uint32_t>());
+    }
+
+    DocumentStatus ReadStatus() {
+        const uint8_t status = ReadInteger<uint8_t>();
+        if (status > DocumentStatus::REMOVED) {
+            throw std::invalid_argument("unknown document status in message"s);
+        }
+        return static_cast<DocumentStatus>(status);
+    }
+
+    // Counts are checked against the remaining bytes before anything is
+    // allocated for them
+    uint32_t ReadCount(size_t min_item_size) {
+        const uint32_t count = ReadInteger<uint32_t>();
+        if (count > (payload_.size() - position_) / min_item_size) {
+            throw std::invalid_argument("truncated message"s);
+        }
+        return count;
+    }
+
+    void Finish() const {
+        if (position_ != payload_.size()) {
+            throw std::invalid_argument("unexpected bytes at the end of a message"s);
+        }
+    }
+
+private:
+    std::string_view payload_;
+    size_t position_ = 0;
+
+    std::string_view Take(size_t count) {
+        if (count > payload_.size() - position_) {
+            throw std::invalid_argument("truncated message"s);
+        }
+        const std::string_view bytes = payload_.substr(position_, count);
+        position_ += count;
+        return bytes;
+    }
+};
+
+void WriteResponseHeader(FrameWriter& writer, uint32_t request_id, uint8_t result) {
+    writer.WriteInteger(request_id);
+    writer.WriteInteger(result);
+}
+
+} // namespace
+
+size_t GetFrameSize(std::string_view buffer) {
+    if (buffer.size() < FRAME_HEADER_SIZE) {
+        return 0;
+    }
+    const uint32_t payload_size = PayloadReader(buffer.substr(0, FRAME_HEADER_SIZE)).ReadInteger<uint32_t>();
+    if (payload_size > MAX_FRAME_SIZE) {
+        throw std::invalid_argument("frame exceeds the maximum size"s);
+    }
+    const size_t frame_size = FRAME_HEADER_SIZE + payload_size;
+    return buffer.size() < frame_size ? 0 : frame_size;
+}
+
+std::string_view GetFramePayload(std::string_view frame) {
+    return frame.substr(FRAME_HEADER_SIZE);
+}
+
+void EncodeRequest(const Request& request, std::string& out) {
+    FrameWriter writer(out);
+    writer.WriteInteger(static_cast<uint8_t>(request.type));
+    writer.WriteInteger(request.request_id);
+    switch (request.type) {
+    case RequestType::FIND_TOP_DOCUMENTS:
+        writer.WriteInteger(static_cast<uint8_t>(request.status));
+        writer.WriteInteger(request.top_k);
+        writer.WriteString(request.text);
+        break;
+    case RequestType::MATCH_DOCUMENT:
+        writer.WriteInteger(request.document_id);
+        writer.WriteString(request.text);
+        break;
+    case RequestType::ADD_DOCUMENT:
+        writer.WriteInteger(request.document_id);
+        writer.WriteInteger(static_cast<uint8_t>(request.status));
+        writer.WriteInteger(static_cast<uint32_t>(request.ratings.size()));
+        for (const int rating : request.ratings) {
+            writer.WriteInteger(rating);
+        }
+        writer.WriteString(request.text);
+        break;
+    case RequestType::REMOVE_DOCUMENT:
+        writer.WriteInteger(request.document_id);
+        break;
+    }
+    writer.Finish();
+}
+
+Request DecodeRequest(std::string_view payload) {
+    PayloadReader reader(payload);
+    Request request;
+    request.type = static_cast<RequestType>(reader.ReadInteger<uint8_t>());
+    request.request_id = reader.ReadInteger<uint32_t>();
+    switch (request.type) {
+    case RequestType::FIND_TOP_DOCUMENTS:
+        request.status = reader.ReadStatus();
+        request.top_k = reader.ReadInteger<uint32_t>();
+        request.text = reader.ReadString();
+        break;
+    case RequestType::MATCH_DOCUMENT:
+        request.document_id = reader.ReadInteger<int32_t>();
+        request.text = reader.ReadString();
+        break;
+    case RequestType::ADD_DOCUMENT:
+        request.document_id = reader.ReadInteger<int32_t>();
+        request.status = reader.ReadStatus();
+        request.ratings.resize(reader.ReadCount(sizeof(int32_t)));
+        for (int& rating : request.ratings) {
+            rating = reader.ReadInteger<int32_t>();
+        }
+        request.text = reader.ReadString();
+        break;
+    case RequestType::REMOVE_DOCUMENT:
+        request.document_id = reader.ReadInteger<int32_t>();
+        break;
+    default:
+        throw std::invalid_argument("unknown request type"s);
+    }
+    reader.Finish();
+    return request;
+}
+
+void EncodeDocumentsResponse(uint32_t request_id, const std::vector<Document>& documents, std::string& out) {
+    FrameWriter writer(out);
+    WriteResponseHeader(writer, request_id, RESULT_OK);
+    writer.WriteInteger(static_cast<uint32_t>(documents.size()));
+    for (const Document& document : documents) {
+        writer.WriteInteger(document.id);
+        writer.WriteDouble(document.relevance);
+        writer.WriteInteger(document.rating);
+    }
+    writer.Finish();
+}
+
+void EncodeMatchResponse(uint32_t request_id, const std::vector<std::string_view>& words, DocumentStatus status, std::string& out) {
+    FrameWriter writer(out);
+    WriteResponseHeader(writer, request_id, RESULT_OK);
+    writer.WriteInteger(static_cast<uint8_t>(status));
+    writer.WriteInteger(static_cast<uint32_t>(words.size()));
+    for (const std::string_view word : words) {
+        writer.WriteString(word);
+    }
+    writer.Finish();
+}
+
+void EncodeEmptyResponse(uint32_t request_id, std::string& out) {
+    FrameWriter writer(out);
+    WriteResponseHeader(writer, request_id, RESULT_OK);
+    writer.Finish();
+}
+
+void EncodeErrorResponse(uint32_t request_id, std::string_view message, std::string& out) {
+    FrameWriter writer(out);
+    WriteResponseHeader(writer, request_id, RESULT_ERROR);
+    writer.WriteString(message);
+    writer.Finish();
+}
+
+Response DecodeResponse(RequestType type, std::string_view payload) {
+    PayloadReader reader(payload);
+    Response response;
+    response.request_id = reader.ReadInteger<uint32_t>();
+    const uint8_t result = reader.ReadInteger<uint8_t>();
+    if (result == RESULT_ERROR) {
+        response.is_ok = false;
+        response.error = reader.ReadString();
+    }
+    else if (result != RESULT_OK) {
+        throw std::invalid_argument("unknown response result"s);
+    }
+    else if (type == RequestType::FIND_TOP_DOCUMENTS) {
+        response.documents.resize(reader.ReadCount(2 * sizeof(int32_t) + sizeof(double)));
+        for (Document& document : response.documents) {
+            document.id = reader.ReadInteger<int32_t>();
+            document.relevance = reader.ReadDouble();
+            document.rating = reader.ReadInteger<int32_t>();
+        }
+    }
+    else if (type == RequestType::MATCH_DOCUMENT) {
+        response.status = reader.ReadStatus();
+        response.words.resize(reader.ReadCount(sizeof(uint32_t)));
+        for (std::string& word : response.words) {
+            word = reader.ReadString();
+        }
+    }
+    reader.Finish();
+    return response;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "document.h"
+
+// Wire format of the network query server. Every message is a frame: a
+// 4-byte payload length followed by the payload. Integers are little-endian,
+// a relevance is an IEEE double sent as 8 bytes, a string is a 4-byte length
+// followed by its bytes.
+//
+// Request payload: type (1 byte), request id (4), then by type
+//   FIND_TOP_DOCUMENTS  status (1), top_k (4), query
+//   MATCH_DOCUMENT      document id (4), query
+//   ADD_DOCUMENT        document id (4), status (1), rating count (4), ratings (4 each), text
+//   REMOVE_DOCUMENT     document id (4)
+// Response payload: request id (4), result (1: 0 ok, 1 error), then
+//   FIND_TOP_DOCUMENTS  document count (4), each id (4), relevance (8), rating (4)
+//   MATCH_DOCUMENT      status (1), word count (4), words
+//   any request         error message when the result is an error
+// Responses on a connection come in the order of its requests.
+
+const size_t FRAME_HEADER_SIZE = 4;
+const size_t MAX_FRAME_SIZE = 16 << 20;
+
+enum class RequestType : uint8_t {
+    FIND_TOP_DOCUMENTS = 1,
+    MATCH_DOCUMENT = 2,
+    ADD_DOCUMENT = 3,
+    REMOVE_DOCUMENT = 4,
+};
+
+struct Request {
+    RequestType type = RequestType::FIND_TOP_DOCUMENTS;
+    uint32_t request_id = 0;
+    int document_id = 0;
+    DocumentStatus status = DocumentStatus::ACTUAL;
+    uint32_t top_k = 0;
+    // Query or document text; a decoded request points into its frame
+    std::string_view text;
+    std::vector<int> ratings;
+};
+
+struct Response {
+    uint32_t request_id = 0;
+    bool is_ok = true;
+    std::string error;
+    std::vector<Document> documents;
+    std::vector<std::string> words;
+    DocumentStatus status = DocumentStatus::ACTUAL;
+};
+
+// Size of the whole frame at the start of the buffer including its header,
+// or 0 while the frame is incomplete; throws on a frame over MAX_FRAME_SIZE
+size_t GetFrameSize(std::string_view buffer);
+std::string_view GetFramePayload(std::string_view frame);
+
+// Encoders append one whole frame to `out`; decoders take a frame payload
+// and throw std::invalid_argument on malformed input
+void EncodeRequest(const Request& request, std::string& out);
+Request DecodeRequest(std::string_view payload);
+
+void EncodeDocumentsResponse(uint32_t request_id, const std::vector<Document>& documents, std::string& out);
+void EncodeMatchResponse(uint32_t request_id, const std::vector<std::string_view>& words, DocumentStatus status, std::string& out);
+void EncodeEmptyResponse(uint32_t request_id, std::string& out);
+void EncodeErrorResponse(uint32_t request_id, std::string_view message, std::string& out);
+// The body of a response is read according to the type of its request
+Response DecodeResponse(RequestType type, std::string_view payload);
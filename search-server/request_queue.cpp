@@ -16,23 +16,19 @@
     
     
     std::vector<Document> RequestQueue::AddFindRequest(const std::string& raw_query, DocumentStatus status) {
-        QueryResult query_result;
-        std::vector<Document> result;
-        result = search_server_.FindTopDocuments(raw_query, status);
-        query_result.result_is_empty = result.empty();
-        TickOfTime();
-        requests_.push_back(query_result);
-        if (query_result.result_is_empty) {
-            ++no_result_requests;
-        }
-        return result;
-       
+        return RecordRequest(search_server_.FindTopDocuments(raw_query, status));
     }
 
     std::vector<Document> RequestQueue::AddFindRequest(const std::string& raw_query) {
+        return RecordRequest(search_server_.FindTopDocuments(raw_query));
+    }
+
+    std::vector<Document> RequestQueue::AddFindRequest(const SearchServer::PreparedQuery& query, DocumentStatus status) {
+        return RecordRequest(search_server_.FindTopDocuments(query, status));
+    }
+
+    std::vector<Document> RequestQueue::RecordRequest(std::vector<Document> result) {
         QueryResult query_result;
-        std::vector<Document> result;
-        result = search_server_.FindTopDocuments(raw_query);
         query_result.result_is_empty = result.empty();
         TickOfTime();
         requests_.push_back(query_result);
@@ -40,7 +36,6 @@
             ++no_result_requests;
         }
         return result;
-       
     }
     int RequestQueue::GetNoResultRequests() const {
         return no_result_requests;
@@ -13,10 +13,17 @@ public:
 
     std::vector<Document> AddFindRequest(const std::string& raw_query);
 
+    template <typename DocumentPredicate>
+    std::vector<Document> AddFindRequest(const SearchServer::PreparedQuery& query, DocumentPredicate document_predicate);
+
+    std::vector<Document> AddFindRequest(const SearchServer::PreparedQuery& query, DocumentStatus status = DocumentStatus::ACTUAL);
+
     int GetNoResultRequests() const;
 private:
 
     void TickOfTime();
+    // Counts the request with its result towards the statistics
+    std::vector<Document> RecordRequest(std::vector<Document> result);
 
     struct QueryResult {
         bool result_is_empty;
@@ -32,16 +39,12 @@ private:
 
 template <typename DocumentPredicate>
 std::vector<Document> RequestQueue::AddFindRequest(const std::string& raw_query, DocumentPredicate document_predicate) {
-    QueryResult query_result;
-    std::vector<Document> result;
-    result = search_server_.FindTopDocuments(raw_query, document_predicate);
-    query_result.result_is_empty = result.empty();
-    TickOfTime();
-    requests_.push_back(query_result);
-    if (query_result.result_is_empty) {
-        ++no_result_requests;
-    }
-    return result;
+    return RecordRequest(search_server_.FindTopDocuments(raw_query, document_predicate));
+}
+
+template <typename DocumentPredicate>
+std::vector<Document> RequestQueue::AddFindRequest(const SearchServer::PreparedQuery& query, DocumentPredicate document_predicate) {
+    return RecordRequest(search_server_.FindTopDocuments(query, document_predicate));
 }
 
 
@@ -0,0 +1,22 @@
+#include "scoring.h"
+
+TfIdfScoring::Scorer::Scorer(const CollectionStatistics& statistics)
+    :document_count_(statistics.document_count)
+{}
+
+TfIdfScoring::Scorer TfIdfScoring::GetScorer(const CollectionStatistics& statistics) const {
+    return Scorer(statistics);
+}
+
+Bm25Scoring::Bm25Scoring(double k1, double b)
+    :k1_(k1), b_(b)
+{}
+
+Bm25Scoring::Scorer::Scorer(double k1, double b, const CollectionStatistics& statistics)
+    :k1_(k1), b_(b), document_count_(statistics.document_count),
+    average_document_length_(statistics.average_document_length > 0.0 ? statistics.average_document_length : 1.0)
+{}
+
+Bm25Scoring::Scorer Bm25Scoring::GetScorer(const CollectionStatistics& statistics) const {
+    return Scorer(k1_, b_, statistics);
+}
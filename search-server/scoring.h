@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cmath>
+
+// Scoring policies are plain classes passed to SearchServer as template
+// arguments, so their formulas are inlined into the scoring loops. A policy
+// hands out a Scorer bound to the statistics of the collection a query runs
+// on; the scorer weighs every query term once and then scores postings by
+// their term frequency, the share of the document's words the term takes.
+
+struct CollectionStatistics {
+    int document_count;
+    double average_document_length;
+};
+
+// Term frequency times log(document count / document frequency)
+class TfIdfScoring {
+public:
+    class Scorer {
+    public:
+        explicit Scorer(const CollectionStatistics& statistics);
+
+        double GetTermWeight(int document_frequency) const;
+        double Score(double term_weight, double term_freq, int document_length) const;
+        // Upper bound of Score over postings with term frequencies up to max_term_freq
+        double GetMaxScore(double term_weight, double max_term_freq) const;
+
+    private:
+        int document_count_;
+    };
+
+    Scorer GetScorer(const CollectionStatistics& statistics) const;
+};
+
+// Okapi BM25: term counts saturate with k1, and b sets how much documents
+// longer than average are penalized
+class Bm25Scoring {
+public:
+    explicit Bm25Scoring(double k1 = 1.2, double b = 0.75);
+
+    class Scorer {
+    public:
+        Scorer(double k1, double b, const CollectionStatistics& statistics);
+
+        double GetTermWeight(int document_frequency) const;
+        double Score(double term_weight, double term_freq, int document_length) const;
+        double GetMaxScore(double term_weight, double max_term_freq) const;
+
+    private:
+        double k1_;
+        double b_;
+        int document_count_;
+        double average_document_length_;
+    };
+
+    Scorer GetScorer(const CollectionStatistics& statistics) const;
+
+private:
+    double k1_;
+    double b_;
+};
+
+inline double TfIdfScoring::Scorer::GetTermWeight(int document_frequency) const {
+    return std::log(document_count_ * 1.0 / document_frequency);
+}
+
+inline double TfIdfScoring::Scorer::Score(double term_weight, double term_freq, int) const {
+    return term_freq * term_weight;
+}
+
+inline double TfIdfScoring::Scorer::GetMaxScore(double term_weight, double max_term_freq) const {
+    return max_term_freq * term_weight;
+}
+
+inline double Bm25Scoring::Scorer::GetTermWeight(int document_frequency) const {
+    return std::log(1.0 + (document_count_ - document_frequency + 0.5) / (document_frequency + 0.5));
+}
+
+inline double Bm25Scoring::Scorer::Score(double term_weight, double term_freq, int document_length) const {
+    const double term_count = term_freq * document_length;
+    return term_weight * term_count * (k1_ + 1.0)
+        / (term_count + k1_ * (1.0 - b_ + b_ * document_length / average_document_length_));
+}
+
+// Divided by the document length, the score only grows with it, so the
+// bound is its limit for infinitely long documents
+inline double Bm25Scoring::Scorer::GetMaxScore(double term_weight, double max_term_freq) const {
+    if (b_ == 0.0) {
+        return term_weight * (k1_ + 1.0);
+    }
+    return term_weight * max_term_freq * (k1_ + 1.0) / (max_term_freq + k1_ * b_ / average_document_length_);
+}
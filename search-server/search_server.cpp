@@ -1,6 +1,8 @@
 
+#include <chrono>
 #include <cmath>
 #include <string_view>
+#include <thread>
 
 
 #include "search_server.h"
@@ -13,6 +15,44 @@ using std::string_literals::operator""s;
     SearchServer::SearchServer() {
     }
 
+    SearchServer::SearchServer(const SearchServer& other)
+        :dictionary_(other.dictionary_)
+        , stop_terms_(other.stop_terms_)
+        , segments_()
+        , term_document_counts_(other.term_document_counts_)
+        , document_count_(other.document_count_)
+        , document_ordinals_(other.document_ordinals_)
+        , document_ids_(other.document_ids_)
+        , document_ratings_(other.document_ratings_)
+        , document_statuses_(other.document_statuses_)
+        , document_lengths_(other.document_lengths_)
+        , total_document_length_(other.total_document_length_)
+        , tombstones_(other.tombstones_)
+        , status_bitmaps_(other.status_bitmaps_)
+        , word_frequency_(other.word_frequency_)
+        , generation_(other.generation_)
+        , impact_ordered_(other.impact_ordered_)
+    {
+        // Compact purges segments in place, so none may be shared
+        segments_.reserve(other.segments_.size());
+        for (const std::shared_ptr<IndexSegment>& segment : other.segments_) {
+            segments_.push_back(std::make_shared<IndexSegment>(*segment));
+        }
+    }
+
+    SearchServer& SearchServer::operator=(const SearchServer& other) {
+        if (this != &other) {
+            FinishSegmentMerge(true);
+            *this = SearchServer(other);
+        }
+        return *this;
+    }
+
+    uint64_t SearchServer::NextDictionaryId() {
+        static std::atomic<uint64_t> next_id{ 1 };
+        return next_id.fetch_add(1, std::memory_order_relaxed);
+    }
+
     SearchServer::SearchServer(std::string_view stop_words) :SearchServer(SplitIntoWords(stop_words))
     {}
     SearchServer::SearchServer(const std::string& stop_words) :SearchServer(SplitIntoWords(std::string_view(stop_words)))
@@ -22,20 +62,176 @@ using std::string_literals::operator""s;
         if (document_id < 0) {
             throw std::invalid_argument("trying to add a document with a negative id"s);
         }
-        if (document_info_.count(document_id)) {
+        if (document_ordinals_.count(document_id)) {
             throw std::invalid_argument("attempt to add a document with an existing id"s);
         }
-        CheckValidWord(document);
+        // Splitting validates the text, so it goes before any state changes
+        std::vector<TermId> words = SplitIntoTermsNoStop(document);
+        FinishSegmentMerge(false);
 
-        storage.emplace_back(document);
-        document_count_.insert(document_id);
-        const std::vector<std::string_view> words = SplitIntoWordsNoStop(storage.back());
+        const int ordinal = static_cast<int>(document_ids_.size());
+        AppendDocumentAttributes(document_id, status, ComputeAverageRating(ratings), static_cast<int>(words.size()));
+        ++generation_;
+
+        std::sort(words.begin(), words.end());
         const double inv_word_count = 1.0 / words.size();
-        for (const std::string_view& word : words) {
-            word_to_document_freqs_[word][document_id] += inv_word_count;
-            word_frequency_[document_id][word] += inv_word_count;
+        std::vector<std::pair<TermId, double>>& document_freqs = word_frequency_.emplace_back();
+        for (const TermId word : words) {
+            if (document_freqs.empty() || document_freqs.back().first != word) {
+                document_freqs.emplace_back(word, 0.0);
+            }
+            document_freqs.back().second += inv_word_count;
+        }
+        term_document_counts_.resize(dictionary_.size());
+        IndexSegment& segment = *segments_.back();
+        for (const auto& [word, term_freq] : document_freqs) {
+            segment.GetPostings(word).Add(ordinal, term_freq);
+            ++term_document_counts_[word];
+        }
+        if (ordinal + 1 - segment.GetFirstOrdinal() >= SEGMENT_SEAL_DOCUMENT_COUNT) {
+            SealMutableSegment();
+        }
+    }
+
+    void SearchServer::AddDocuments(const std::vector<BatchDocument>& documents) {
+        // Words of one chunk of the batch, numbered by a chunk-local dictionary
+        struct PartialIndex {
+            size_t first_document;
+            size_t end_document;
+            std::unordered_map<std::string_view, uint32_t> local_terms;
+            std::vector<std::string_view> terms;
+            std::vector<bool> stop_terms;
+            std::vector<std::vector<std::pair<uint32_t, double>>> document_freqs;
+            std::vector<std::vector<std::pair<size_t, double>>> postings;
+            std::vector<int> lengths;
+            bool is_valid = true;
+        };
+
+        std::set<int> batch_ids;
+        for (const BatchDocument& document : documents) {
+            if (document.document_id < 0) {
+                throw std::invalid_argument("trying to add a document with a negative id"s);
+            }
+            if (document_ordinals_.count(document.document_id) || !batch_ids.insert(document.document_id).second) {
+                throw std::invalid_argument("attempt to add a document with an existing id"s);
+            }
+        }
+
+        const size_t chunk_count = std::max<size_t>(1, std::min<size_t>(documents.size(), 4 * std::thread::hardware_concurrency()));
+        std::vector<PartialIndex> partial_indexes(chunk_count);
+        for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+            partial_indexes[chunk].first_document = documents.size() * chunk / chunk_count;
+            partial_indexes[chunk].end_document = documents.size() * (chunk + 1) / chunk_count;
+        }
+        std::for_each(std::execution::par, partial_indexes.begin(), partial_indexes.end(),
+            [this, &documents](PartialIndex& partial)
+            {
+                std::vector<uint32_t> words;
+                for (size_t i = partial.first_document; i < partial.end_document; ++i) {
+                    words.clear();
+                    try {
+                        for (const std::string_view word : SplitIntoWords(documents[i].text)) {
+                            auto it = partial.local_terms.find(word);
+                            if (it == partial.local_terms.end()) {
+                                it = partial.local_terms.emplace(word, static_cast<uint32_t>(partial.terms.size())).first;
+                                partial.terms.push_back(word);
+                                partial.stop_terms.push_back(IsStopWord(dictionary_.Find(word)));
+                                partial.postings.emplace_back();
+                            }
+                            if (!partial.stop_terms[it->second]) {
+                                words.push_back(it->second);
+                            }
+                        }
+                    }
+                    catch (const std::invalid_argument&) {
+                        partial.is_valid = false;
+                        return;
+                    }
+                    std::sort(words.begin(), words.end());
+                    const double inv_word_count = 1.0 / words.size();
+                    partial.lengths.push_back(static_cast<int>(words.size()));
+                    std::vector<std::pair<uint32_t, double>>& document_freqs = partial.document_freqs.emplace_back();
+                    for (const uint32_t word : words) {
+                        if (document_freqs.empty() || document_freqs.back().first != word) {
+                            document_freqs.emplace_back(word, 0.0);
+                        }
+                        document_freqs.back().second += inv_word_count;
+                    }
+                    for (const auto& [word, term_freq] : document_freqs) {
+                        partial.postings[word].emplace_back(i, term_freq);
+                    }
+                }
+            });
+        if (std::any_of(partial_indexes.begin(), partial_indexes.end(), [](const PartialIndex& partial) { return !partial.is_valid; })) {
+            throw std::invalid_argument("stop_words contains invalid characters"s);
+        }
+
+        // Merge: intern the chunk dictionaries, then append every global
+        // posting list in parallel, chunks in batch order keep it sorted
+        FinishSegmentMerge(false);
+        const int first_ordinal = static_cast<int>(document_ids_.size());
+        std::vector<std::vector<TermId>> global_terms(chunk_count);
+        for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+            for (const std::string_view term : partial_indexes[chunk].terms) {
+                global_terms[chunk].push_back(dictionary_.Intern(term));
+            }
+        }
+        term_document_counts_.resize(dictionary_.size());
+        std::vector<std::vector<std::pair<size_t, uint32_t>>> term_sources(dictionary_.size());
+        std::vector<TermId> touched_terms;
+        for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+            for (uint32_t local = 0; local < global_terms[chunk].size(); ++local) {
+                const TermId term = global_terms[chunk][local];
+                if (term_sources[term].empty()) {
+                    touched_terms.push_back(term);
+                }
+                term_sources[term].emplace_back(chunk, local);
+                term_document_counts_[term] += static_cast<uint32_t>(partial_indexes[chunk].postings[local].size());
+            }
+        }
+        // Lists are created up front: creating them while appending in
+        // parallel would move the segment's storage under other threads
+        IndexSegment& segment = *segments_.back();
+        for (const TermId term : touched_terms) {
+            segment.GetPostings(term);
+        }
+        std::for_each(std::execution::par, touched_terms.begin(), touched_terms.end(),
+            [&segment, &term_sources, &partial_indexes, first_ordinal](TermId term)
+            {
+                PostingList& postings = *segment.FindPostings(term);
+                for (const auto& [chunk, local] : term_sources[term]) {
+                    for (const auto& [document, term_freq] : partial_indexes[chunk].postings[local]) {
+                        postings.Add(first_ordinal + static_cast<int>(document), term_freq);
+                    }
+                }
+            });
+
+        word_frequency_.resize(first_ordinal + documents.size());
+        for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+            PartialIndex& partial = partial_indexes[chunk];
+            const std::vector<TermId>& terms = global_terms[chunk];
+            std::for_each(std::execution::par, partial.document_freqs.begin(), partial.document_freqs.end(),
+                [this, &partial, &terms, first_ordinal](std::vector<std::pair<uint32_t, double>>& local_freqs)
+                {
+                    const size_t document = partial.first_document + (&local_freqs - partial.document_freqs.data());
+                    std::vector<std::pair<TermId, double>>& document_freqs = word_frequency_[first_ordinal + document];
+                    for (const auto& [local, term_freq] : local_freqs) {
+                        document_freqs.emplace_back(terms[local], term_freq);
+                    }
+                    std::sort(document_freqs.begin(), document_freqs.end());
+                });
+        }
+
+        for (const PartialIndex& partial : partial_indexes) {
+            for (size_t i = partial.first_document; i < partial.end_document; ++i) {
+                AppendDocumentAttributes(documents[i].document_id, documents[i].status, ComputeAverageRating(documents[i].ratings),
+                    partial.lengths[i - partial.first_document]);
+            }
+        }
+        ++generation_;
+        if (static_cast<int>(document_ids_.size()) - segment.GetFirstOrdinal() >= SEGMENT_SEAL_DOCUMENT_COUNT) {
+            SealMutableSegment();
         }
-        document_info_[document_id] = { ComputeAverageRating(ratings),status };
     }
 
     void SearchServer::RemoveDocument(int document_id) {
@@ -43,13 +239,19 @@ using std::string_literals::operator""s;
             return;
         }
        
-        for (auto [word, TF] : word_frequency_[document_id]) {
-            word_to_document_freqs_[word].erase(document_id);
+        // Postings stay where they are until Compact or a segment merge purges
+        // them; only the counts behind idf are updated right away
+        const int ordinal = document_ordinals_.at(document_id);
+        for (auto [word, TF] : word_frequency_[ordinal]) {
+            --term_document_counts_[word];
         }
 
+        MarkRemoved(ordinal);
+        ++generation_;
         document_count_.erase(document_id);
-        document_info_.erase(document_id);
-        word_frequency_.erase(document_id);
+        document_ordinals_.erase(document_id);
+        word_frequency_[ordinal].clear();
+        word_frequency_[ordinal].shrink_to_fit();
     }
     void SearchServer::RemoveDocument(std::execution::sequenced_policy, int document_id) {
         SearchServer::RemoveDocument(document_id);
@@ -58,97 +260,403 @@ using std::string_literals::operator""s;
         if (!document_count_.count(document_id)) {
             return;
         }
-        std::vector<std::string_view> word_erase(word_frequency_[document_id].size());
-        std::transform(std::execution::par, word_frequency_[document_id].begin(), word_frequency_[document_id].end(), word_erase.begin(),
+        const int ordinal = document_ordinals_.at(document_id);
+        std::vector<TermId> word_erase(word_frequency_[ordinal].size());
+        std::transform(std::execution::par, word_frequency_[ordinal].begin(), word_frequency_[ordinal].end(), word_erase.begin(),
             [](auto word_tf)
             {
                 return word_tf.first;
             });
-        std::for_each(std::execution::par, word_erase.begin(), word_erase.end(), [this,document_id](auto word)
+        std::for_each(std::execution::par, word_erase.begin(), word_erase.end(), [this](TermId word)
             {
-                word_to_document_freqs_.at(word).erase(document_id);
+                --term_document_counts_[word];
             });
 
+        MarkRemoved(ordinal);
+        ++generation_;
         document_count_.erase(document_id);
-        document_info_.erase(document_id);
-        word_frequency_.erase(document_id);
+        document_ordinals_.erase(document_id);
+        word_frequency_[ordinal].clear();
+        word_frequency_[ordinal].shrink_to_fit();
     }
 
 
-    int SearchServer::GetDocumentCount() const {
-        return static_cast<int>(document_count_.size());
+    void SearchServer::Compact() {
+        // The running merge still refers to the old term ids
+        FinishSegmentMerge(true);
+        // Cache keys and prepared queries hold term ids, which are renumbered below
+        ++generation_;
+        dictionary_id_ = NextDictionaryId();
+        if (document_count_.size() < document_ids_.size()) {
+            RenumberOrdinals();
+        }
+        TermDictionary dictionary;
+        std::vector<bool> stop_terms;
+        std::vector<uint32_t> term_document_counts;
+        std::vector<TermId> new_terms(dictionary_.size(), TermDictionary::NO_TERM);
+        for (TermId term = 0; term < dictionary_.size(); ++term) {
+            const bool is_used = GetTermDocumentCount(term) > 0;
+            if (!is_used && !IsStopWord(term)) {
+                continue;
+            }
+            new_terms[term] = dictionary.Intern(dictionary_.GetTerm(term));
+            stop_terms.push_back(IsStopWord(term));
+            term_document_counts.push_back(GetTermDocumentCount(term));
+        }
+        // Surviving terms keep their relative order, so forward index entries
+        // and sealed segments stay sorted
+        for (std::vector<std::pair<TermId, double>>& document_freqs : word_frequency_) {
+            for (auto& [term, term_freq] : document_freqs) {
+                term = new_terms[term];
+            }
+        }
+        for (std::shared_ptr<IndexSegment>& segment : segments_) {
+            segment->RemapTerms(new_terms);
+        }
+        dictionary_ = std::move(dictionary);
+        stop_terms_ = std::move(stop_terms);
+        term_document_counts_ = std::move(term_document_counts);
     }
 
-    std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(std::string_view raw_query, int document_id) const {
+    void SearchServer::RenumberOrdinals() {
+        // Live ordinals keep their order, so postings stay sorted; the extra
+        // entry maps the end of the last sealed segment
+        const size_t ordinal_count = document_ids_.size();
+        std::vector<int> new_ordinals(ordinal_count + 1);
+        int live_count = 0;
+        for (size_t ordinal = 0; ordinal < ordinal_count; ++ordinal) {
+            new_ordinals[ordinal] = live_count;
+            live_count += tombstones_[ordinal] ? 0 : 1;
+        }
+        new_ordinals[ordinal_count] = live_count;
 
+        for (std::shared_ptr<IndexSegment>& segment : segments_) {
+            segment->Renumber(tombstones_, new_ordinals);
+        }
+        // Sealed segments left without documents are dropped
+        segments_.erase(std::remove_if(segments_.begin(), segments_.end() - 1,
+            [](const std::shared_ptr<IndexSegment>& segment) {
+                return segment->GetFirstOrdinal() == segment->GetEndOrdinal();
+            }), segments_.end() - 1);
+
+        for (size_t ordinal = 0; ordinal < ordinal_count; ++ordinal) {
+            const int new_ordinal = new_ordinals[ordinal];
+            if (tombstones_[ordinal] || new_ordinal == static_cast<int>(ordinal)) {
+                continue;
+            }
+            document_ids_[new_ordinal] = document_ids_[ordinal];
+            document_ratings_[new_ordinal] = document_ratings_[ordinal];
+            document_statuses_[new_ordinal] = document_statuses_[ordinal];
+            document_lengths_[new_ordinal] = document_lengths_[ordinal];
+            word_frequency_[new_ordinal] = std::move(word_frequency_[ordinal]);
+            document_ordinals_[document_ids_[new_ordinal]] = new_ordinal;
+        }
+        document_ids_.resize(live_count);
+        document_ids_.shrink_to_fit();
+        document_ratings_.resize(live_count);
+        document_ratings_.shrink_to_fit();
+        document_statuses_.resize(live_count);
+        document_statuses_.shrink_to_fit();
+        document_lengths_.resize(live_count);
+        document_lengths_.shrink_to_fit();
+        word_frequency_.resize(live_count);
+        word_frequency_.shrink_to_fit();
+        tombstones_.assign(live_count, false);
+        tombstones_.shrink_to_fit();
+        for (size_t status = 0; status < STATUS_COUNT; ++status) {
+            std::vector<bool>& bitmap = status_bitmaps_[status];
+            bitmap.assign(live_count, false);
+            bitmap.shrink_to_fit();
+            for (int ordinal = 0; ordinal < live_count; ++ordinal) {
+                bitmap[ordinal] = static_cast<size_t>(document_statuses_[ordinal]) == status;
+            }
+        }
+    }
 
-        Query query = ParseQuery(false,raw_query);
+    void SearchServer::SetImpactOrdered(bool impact_ordered) {
+        // A merge started before the change would come back in the old layout
+        FinishSegmentMerge(true);
+        impact_ordered_ = impact_ordered;
+        for (size_t segment = 0; segment + 1 < segments_.size(); ++segment) {
+            if (impact_ordered && !segments_[segment]->HasImpactPostings()) {
+                segments_[segment]->BuildImpactPostings();
+            }
+            else if (!impact_ordered) {
+                segments_[segment]->DropImpactPostings();
+            }
+        }
+    }
 
-        std::vector<std::string_view> plus_words_document;
-        for (const std::string_view& word : query.minus_words) {
-            if (word_to_document_freqs_.count(word)) {
-                if (word_to_document_freqs_.at(word).count(document_id)) {
-                    DocumentStatus status = document_info_.at(document_id).status;
-                    std::tuple<std::vector<std::string_view>, DocumentStatus> result = { plus_words_document, status };
-                    return result;
-                    
+    void SearchServer::SaveSnapshot(const std::string& path) const {
+        SnapshotWriter writer(path);
+        writer.WriteArray(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        writer.Write(SNAPSHOT_VERSION);
+        writer.Write(uint32_t(0));
+
+        const uint64_t term_count = dictionary_.size();
+        std::vector<uint64_t> term_offsets = { 0 };
+        std::string text;
+        std::vector<uint8_t> stop_flags;
+        std::vector<uint64_t> posting_offsets = { 0 };
+        for (TermId term = 0; term < term_count; ++term) {
+            text += dictionary_.GetTerm(term);
+            term_offsets.push_back(text.size());
+            stop_flags.push_back(IsStopWord(term));
+            posting_offsets.push_back(posting_offsets.back() + GetTermDocumentCount(term));
+        }
+        writer.Write(term_count);
+        writer.WriteArray(term_offsets.data(), term_offsets.size());
+        writer.WriteArray(text.data(), text.size());
+        writer.WriteArray(stop_flags.data(), stop_flags.size());
+        std::vector<int> posting_ordinals;
+        std::vector<double> posting_freqs;
+        posting_ordinals.reserve(posting_offsets.back());
+        posting_freqs.reserve(posting_offsets.back());
+        // Segments are visited in ordinal order, so every term's list comes out sorted
+        for (TermId term = 0; term < term_count; ++term) {
+            for (const std::shared_ptr<IndexSegment>& segment : segments_) {
+                const PostingList* postings = segment->FindPostings(term);
+                if (postings == nullptr) {
+                    continue;
+                }
+                for (const auto& [ordinal, term_freq] : *postings) {
+                    if (!tombstones_[ordinal]) {
+                        posting_ordinals.push_back(ordinal);
+                        posting_freqs.push_back(term_freq);
+                    }
                 }
             }
         }
-        for (const std::string_view& word : query.plus_words) {
-            if (word_to_document_freqs_.count(word)) {
-                if (word_to_document_freqs_.at(word).count(document_id)) {
-                    plus_words_document.push_back(word);
+        writer.WriteArray(posting_offsets.data(), posting_offsets.size());
+        writer.WriteArray(posting_ordinals.data(), posting_ordinals.size());
+        writer.WriteArray(posting_freqs.data(), posting_freqs.size());
+
+        const uint64_t ordinal_count = document_ids_.size();
+        std::vector<int32_t> statuses(document_statuses_.begin(), document_statuses_.end());
+        std::vector<uint8_t> live(ordinal_count, 0);
+        for (const auto& [document_id, ordinal] : document_ordinals_) {
+            live[ordinal] = 1;
+        }
+        std::vector<uint64_t> forward_offsets = { 0 };
+        std::vector<TermId> forward_terms;
+        std::vector<double> forward_freqs;
+        for (const std::vector<std::pair<TermId, double>>& document_freqs : word_frequency_) {
+            for (const auto& [term, term_freq] : document_freqs) {
+                forward_terms.push_back(term);
+                forward_freqs.push_back(term_freq);
+            }
+            forward_offsets.push_back(forward_terms.size());
+        }
+        writer.Write(ordinal_count);
+        writer.WriteArray(document_ids_.data(), ordinal_count);
+        writer.WriteArray(document_ratings_.data(), ordinal_count);
+        writer.WriteArray(statuses.data(), ordinal_count);
+        writer.WriteArray(live.data(), ordinal_count);
+        writer.WriteArray(document_lengths_.data(), ordinal_count);
+        writer.WriteArray(forward_offsets.data(), forward_offsets.size());
+        writer.WriteArray(forward_terms.data(), forward_terms.size());
+        writer.WriteArray(forward_freqs.data(), forward_freqs.size());
+        writer.Finish();
+    }
+
+    SearchServer SearchServer::OpenSnapshot(const std::string& path) {
+        auto file = std::make_shared<const MappedFile>(path);
+        SnapshotReader reader(file->data(), file->size());
+        if (!std::equal(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + sizeof(SNAPSHOT_MAGIC), reader.ReadArray<char>(sizeof(SNAPSHOT_MAGIC)))) {
+            throw std::invalid_argument("file is not a search server snapshot"s);
+        }
+        if (reader.Read<uint32_t>() != SNAPSHOT_VERSION) {
+            throw std::invalid_argument("unsupported snapshot version"s);
+        }
+        reader.Read<uint32_t>();
+
+        SearchServer search_server;
+        search_server.snapshot_file_ = file;
+
+        const uint64_t term_count = reader.Read<uint64_t>();
+        const uint64_t* term_offsets = reader.ReadOffsets(term_count);
+        const char* text = reader.ReadArray<char>(term_offsets[term_count]);
+        const uint8_t* stop_flags = reader.ReadArray<uint8_t>(term_count);
+        const uint64_t* posting_offsets = reader.ReadOffsets(term_count);
+        const int* posting_ordinals = reader.ReadArray<int>(posting_offsets[term_count]);
+        const double* posting_freqs = reader.ReadArray<double>(posting_offsets[term_count]);
+        search_server.stop_terms_.resize(term_count);
+        search_server.term_document_counts_.resize(term_count);
+        IndexSegment& segment = *search_server.segments_.back();
+        for (uint64_t term = 0; term < term_count; ++term) {
+            const std::string_view term_text(text + term_offsets[term], term_offsets[term + 1] - term_offsets[term]);
+            if (search_server.dictionary_.InternExternal(term_text) != term) {
+                throw std::invalid_argument("snapshot contains duplicate terms"s);
+            }
+            search_server.stop_terms_[term] = stop_flags[term] != 0;
+            const uint64_t begin = posting_offsets[term];
+            const uint64_t count = posting_offsets[term + 1] - begin;
+            if (std::adjacent_find(posting_ordinals + begin, posting_ordinals + begin + count, std::greater_equal<int>()) != posting_ordinals + begin + count) {
+                throw std::invalid_argument("snapshot postings are not sorted"s);
+            }
+            search_server.term_document_counts_[term] = static_cast<uint32_t>(count);
+            if (count > 0) {
+                segment.GetPostings(static_cast<TermId>(term)).Assign(posting_ordinals + begin, posting_freqs + begin, count);
+            }
+        }
+
+        const uint64_t ordinal_count = reader.Read<uint64_t>();
+        const int* document_ids = reader.ReadArray<int>(ordinal_count);
+        const int* ratings = reader.ReadArray<int>(ordinal_count);
+        const int32_t* statuses = reader.ReadArray<int32_t>(ordinal_count);
+        const uint8_t* live = reader.ReadArray<uint8_t>(ordinal_count);
+        const int* lengths = reader.ReadArray<int>(ordinal_count);
+        const uint64_t* forward_offsets = reader.ReadOffsets(ordinal_count);
+        const TermId* forward_terms = reader.ReadArray<TermId>(forward_offsets[ordinal_count]);
+        const double* forward_freqs = reader.ReadArray<double>(forward_offsets[ordinal_count]);
+        if (ordinal_count > static_cast<uint64_t>(INT_MAX)
+            || std::any_of(posting_ordinals, posting_ordinals + posting_offsets[term_count],
+                [ordinal_count](int ordinal) {
+                    return ordinal < 0 || static_cast<uint64_t>(ordinal) >= ordinal_count;
+                })
+            || std::any_of(forward_terms, forward_terms + forward_offsets[ordinal_count],
+                [term_count](TermId term) {
+                    return term >= term_count;
+                })) {
+            throw std::invalid_argument("snapshot refers to missing documents or terms"s);
+        }
+        search_server.document_ids_.assign(document_ids, document_ids + ordinal_count);
+        search_server.document_ratings_.assign(ratings, ratings + ordinal_count);
+        search_server.document_lengths_.assign(lengths, lengths + ordinal_count);
+        search_server.word_frequency_.resize(ordinal_count);
+        for (uint64_t ordinal = 0; ordinal < ordinal_count; ++ordinal) {
+            if (statuses[ordinal] < 0 || static_cast<size_t>(statuses[ordinal]) >= STATUS_COUNT || lengths[ordinal] < 0) {
+                throw std::invalid_argument("snapshot document attributes are corrupt"s);
+            }
+            search_server.document_statuses_.push_back(static_cast<DocumentStatus>(statuses[ordinal]));
+            search_server.tombstones_.push_back(!live[ordinal]);
+            for (size_t status = 0; status < STATUS_COUNT; ++status) {
+                search_server.status_bitmaps_[status].push_back(live[ordinal] && static_cast<size_t>(statuses[ordinal]) == status);
+            }
+            if (live[ordinal]) {
+                // Removed ordinals may repeat an id, live ones may not
+                if (!search_server.document_count_.insert(document_ids[ordinal]).second) {
+                    throw std::invalid_argument("snapshot contains duplicate documents"s);
                 }
+                search_server.document_ordinals_[document_ids[ordinal]] = static_cast<int>(ordinal);
+                search_server.total_document_length_ += lengths[ordinal];
             }
+            std::vector<std::pair<TermId, double>>& document_freqs = search_server.word_frequency_[ordinal];
+            for (uint64_t i = forward_offsets[ordinal]; i < forward_offsets[ordinal + 1]; ++i) {
+                document_freqs.emplace_back(forward_terms[i], forward_freqs[i]);
+            }
+        }
+        // The whole snapshot becomes one sealed segment
+        if (ordinal_count > 0) {
+            search_server.SealMutableSegment();
         }
-        
-        sort(plus_words_document.begin(), plus_words_document.end());
+        return search_server;
+    }
 
-        DocumentStatus status = document_info_.at(document_id).status;
-        std::tuple<std::vector<std::string_view>, DocumentStatus> result = { plus_words_document, status };
-        return result;
+    int SearchServer::GetDocumentCount() const {
+        return static_cast<int>(document_count_.size());
     }
-    std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(const std::execution::sequenced_policy,  std::string_view raw_query, int document_id) const {
 
-        return MatchDocument(raw_query, document_id);
+    int SearchServer::GetOrdinalCount() const {
+        return static_cast<int>(document_ids_.size());
     }
-    std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(const std::execution::parallel_policy, std::string_view raw_query, int document_id) const {
 
-        Query query = ParseQuery(true,raw_query);
-        
-        std::vector<std::string_view> plus_words_document;
+    QueryCacheStats SearchServer::GetQueryCacheStats() const {
+        return query_cache_->GetStats();
+    }
 
-        if (!std::any_of(std::execution::par, query.minus_words.begin(), query.minus_words.end(), 
-            [this,document_id](const std::string_view& word)
-            {
-                return word_to_document_freqs_.count(word) && word_to_document_freqs_.at(word).count(document_id);
-            })) 
-        {
-            plus_words_document.resize(query.plus_words.size());
-            auto it = std::copy_if(std::execution::par, query.plus_words.begin(), query.plus_words.end(), plus_words_document.begin(), 
-                [this,document_id](const std::string_view& word)
-                {
-                    return word_to_document_freqs_.count(word) && word_to_document_freqs_.at(word).count(document_id);
-                });
-            plus_words_document.erase(it, plus_words_document.end());
-            VectorEraseDuplicate(std::execution::par, plus_words_document);
+    int SearchServer::GetDocumentFrequency(std::string_view word) const {
+        const TermId term = dictionary_.Find(word);
+        return term == TermDictionary::NO_TERM ? 0 : static_cast<int>(GetTermDocumentCount(term));
+    }
+
+    const std::vector<std::string>& SearchServer::PreparedQuery::GetPlusWords() const {
+        return plus_words_;
+    }
+
+    void SearchServer::PreparedQuery::SetInverseDocumentFreqs(std::vector<double> inverse_document_freqs) {
+        if (inverse_document_freqs.size() != plus_words_.size()) {
+            throw std::invalid_argument("expected one idf per plus word"s);
+        }
+        // Top-K pruning bounds scores by summing non-negative term contributions
+        if (!std::all_of(inverse_document_freqs.begin(), inverse_document_freqs.end(), [](double idf) { return idf >= 0.0; })) {
+            throw std::invalid_argument("idfs must be non-negative numbers"s);
+        }
+        plus_word_idfs_ = std::move(inverse_document_freqs);
+        // The resolved terms stay valid, only their idfs are attached
+        query_.plus_word_idfs.clear();
+        for (const size_t position : plus_word_positions_) {
+            query_.plus_word_idfs.push_back(plus_word_idfs_[position]);
+        }
+    }
+
+    SearchServer::PreparedQuery SearchServer::PrepareQuery(std::string_view raw_query) const {
+        PreparedQuery prepared_query;
+        for (const std::string_view word : SplitIntoWords(raw_query)) {
+            const QueryWord query_word = ParseQueryWord(word);
+            if (!query_word.is_stop) {
+                std::vector<std::string>& words = query_word.is_minus ? prepared_query.minus_words_ : prepared_query.plus_words_;
+                words.emplace_back(query_word.data);
+                if (query_word.is_required) {
+                    prepared_query.required_words_.emplace_back(query_word.data);
+                }
+            }
         }
+        for (std::vector<std::string>* words : { &prepared_query.plus_words_, &prepared_query.minus_words_, &prepared_query.required_words_ }) {
+            std::sort(words->begin(), words->end());
+            words->erase(std::unique(words->begin(), words->end()), words->end());
+        }
+        prepared_query.query_ = FindQueryTerms(prepared_query, &prepared_query.plus_word_positions_);
+        prepared_query.dictionary_id_ = dictionary_id_;
+        prepared_query.dictionary_size_ = dictionary_.size();
+        prepared_query.has_unknown_words_ = prepared_query.query_.plus_words.size() != prepared_query.plus_words_.size()
+            || prepared_query.query_.minus_words.size() != prepared_query.minus_words_.size();
+        return prepared_query;
+    }
+
+    std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(std::string_view raw_query, int document_id) const {
+        return MatchDocument(std::execution::seq, ParseQuery(raw_query), document_id);
+    }
+    std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(const std::execution::sequenced_policy,  std::string_view raw_query, int document_id) const {
+        return MatchDocument(std::execution::seq, ParseQuery(raw_query), document_id);
+    }
+    std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(const std::execution::parallel_policy, std::string_view raw_query, int document_id) const {
+        return MatchDocument(std::execution::par, ParseQuery(raw_query), document_id);
+    }
 
-        DocumentStatus status = document_info_.at(document_id).status;
-        std::tuple<std::vector<std::string_view>, DocumentStatus> result = { plus_words_document, status };
-        return result;
+    std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(const PreparedQuery& prepared_query, int document_id) const {
+        Query resolved;
+        return MatchDocument(std::execution::seq, ResolveQuery(prepared_query, resolved), document_id);
+    }
+    std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(const std::execution::sequenced_policy, const PreparedQuery& prepared_query, int document_id) const {
+        return MatchDocument(prepared_query, document_id);
+    }
+    std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(const std::execution::parallel_policy, const PreparedQuery& prepared_query, int document_id) const {
+        Query resolved;
+        return MatchDocument(std::execution::par, ResolveQuery(prepared_query, resolved), document_id);
     }
 
-    std::vector<Document> SearchServer::FindTopDocuments( std::string_view raw_query, DocumentStatus status_document) const {
-        return FindTopDocuments(raw_query, [status_document](int document_id, DocumentStatus status, int rating) { return  status == status_document; });
+    std::vector<Document> SearchServer::FindTopDocuments( std::string_view raw_query, DocumentStatus status_document, size_t top_k) const {
+        return FindTopDocumentsCached(std::execution::seq, ParseQuery(raw_query), status_document, top_k);
     }
 
     std::vector<Document> SearchServer::FindTopDocuments( std::string_view raw_query) const {
-        DocumentStatus status_document = DocumentStatus::ACTUAL;
-        return FindTopDocuments(raw_query, [status_document](int document_id, DocumentStatus status, int rating) { return  status == status_document; });
+        return FindTopDocumentsCached(std::execution::seq, ParseQuery(raw_query), DocumentStatus::ACTUAL, MAX_RESULT_DOCUMENT_COUNT);
+    }
+
+
+    std::vector<Document> SearchServer::FindTopDocuments(QueryExecutor& executor, std::string_view raw_query, DocumentStatus status_document, size_t top_k) const {
+        return FindTopDocumentsCached(executor, ParseQuery(raw_query), status_document, top_k);
     }
 
+    std::vector<Document> SearchServer::FindTopDocuments(const PreparedQuery& prepared_query, DocumentStatus status_document, size_t top_k) const {
+        return FindTopDocuments(std::execution::seq, prepared_query, status_document, top_k);
+    }
+
+    std::vector<Document> SearchServer::FindTopDocuments(QueryExecutor& executor, const PreparedQuery& prepared_query, DocumentStatus status_document, size_t top_k) const {
+        Query resolved;
+        return FindTopDocumentsCached(executor, ResolveQuery(prepared_query, resolved), status_document, top_k);
+    }
 
     std::set<int>::const_iterator SearchServer::begin() const {
         return document_count_.begin();
@@ -158,15 +666,22 @@ using std::string_literals::operator""s;
         return document_count_.end();
     }
 
-    bool SearchServer::IsStopWord(std::string_view word) const {
-        return stop_words_.count(word) > 0;
+    void SearchServer::AddStopWord(std::string_view word) {
+        const TermId term = dictionary_.Intern(word);
+        stop_terms_.resize(dictionary_.size());
+        stop_terms_[term] = true;
+    }
+
+    bool SearchServer::IsStopWord(TermId term) const {
+        return term < stop_terms_.size() && stop_terms_[term];
     }
 
-    std::vector<std::string_view> SearchServer::SplitIntoWordsNoStop(std::string_view text) const {
-        std::vector<std::string_view> words;
+    std::vector<TermId> SearchServer::SplitIntoTermsNoStop(std::string_view text) {
+        std::vector<TermId> words;
         for (const std::string_view& word : SplitIntoWords(text)) {
-            if (!IsStopWord(word)) {
-                words.push_back(word);
+            const TermId term = dictionary_.Intern(word);
+            if (!IsStopWord(term)) {
+                words.push_back(term);
             }
         }
         return words;
@@ -180,16 +695,36 @@ using std::string_literals::operator""s;
         return rating_sum / static_cast<int>(ratings.size());
     }
 
+    std::vector<Document> SearchServer::SelectTopDocuments(const std::vector<Document>& matched_documents, size_t top_k) {
+        TopDocuments top_documents(top_k);
+        for (const Document& document : matched_documents) {
+            top_documents.Push(document);
+        }
+        return top_documents.Extract();
+    }
+
     SearchServer::QueryWord SearchServer::ParseQueryWord(std::string_view text) const {
         QueryWord query_word;
         bool is_minus = false;
+        bool is_required = false;
+        if (text[0] == '+') {
+            if (text.size() == 1) {
+                throw std::invalid_argument("expected word after '+'"s);
+            }
+            if (text[1] == '+' || text[1] == '-') {
+                throw std::invalid_argument("Invalid character '"s + text[1] + "' after '+'"s);
+            }
+            is_required = true;
+            text = text.substr(1);
+        }
         // Word shouldn't be empty
         if (static_cast<int>(text.size()) == 1 ) {
             if (text[0] == '-') {
                 throw std::invalid_argument("expected word after '-'"s);
             }
             else {
-                query_word = { text,is_minus,IsStopWord(text) };
+                const TermId term = dictionary_.Find(text);
+                query_word = { text,term,is_minus,is_required,IsStopWord(term) };
                 return query_word;
             }
         }
@@ -203,63 +738,210 @@ using std::string_literals::operator""s;
             is_minus = true;
             text = text.substr(1);
         }
-        query_word = { text,is_minus,IsStopWord(text) };
+        const TermId term = dictionary_.Find(text);
+        query_word = { text,term,is_minus,is_required,IsStopWord(term) };
         return query_word;
     }
 
-    SearchServer::Query SearchServer::ParseQuery(const bool Need_parallel_version,  std::string_view text) const {
+    SearchServer::Query SearchServer::ParseQuery(std::string_view text) const {
         Query query;
-        CheckValidWord(text);
         for (const std::string_view& word : SplitIntoWords(text)) {
             QueryWord query_word = ParseQueryWord(word);
 
-            if (!query_word.is_stop) {
+            // A required word missing from the dictionary leaves nothing to
+            // find, so it is kept as NO_TERM
+            if (query_word.is_required && !query_word.is_stop) {
+                query.required_words.push_back(query_word.term);
+            }
+            // Words missing from the dictionary cannot match any document
+            if (!query_word.is_stop && query_word.term != TermDictionary::NO_TERM) {
                 if (query_word.is_minus) {
-                    query.minus_words.push_back(query_word.data);
+                    query.minus_words.push_back(query_word.term);
                 }
                 else {
-                    query.plus_words.push_back(query_word.data);
+                    query.plus_words.push_back(query_word.term);
                 }
             }
         }
-        if (!Need_parallel_version) {
-            VectorEraseDuplicate(std::execution::seq, query.minus_words);
-            VectorEraseDuplicate(std::execution::seq, query.plus_words);
-        }
-       
+        VectorEraseDuplicate(std::execution::seq, query.minus_words);
+        VectorEraseDuplicate(std::execution::seq, query.plus_words);
+        VectorEraseDuplicate(std::execution::seq, query.required_words);
+
+        return query;
+    }
 
+    SearchServer::Query SearchServer::FindQueryTerms(const PreparedQuery& prepared_query, std::vector<size_t>* plus_word_positions) const {
+        Query query;
+        // Known plus words with their positions in the prepared query
+        std::vector<std::pair<TermId, size_t>> plus_terms;
+        for (size_t i = 0; i < prepared_query.plus_words_.size(); ++i) {
+            if (const TermId term = dictionary_.Find(prepared_query.plus_words_[i]); term != TermDictionary::NO_TERM) {
+                plus_terms.emplace_back(term, i);
+            }
+        }
+        std::sort(plus_terms.begin(), plus_terms.end());
+        for (const auto& [term, position] : plus_terms) {
+            query.plus_words.push_back(term);
+            if (!prepared_query.plus_word_idfs_.empty()) {
+                query.plus_word_idfs.push_back(prepared_query.plus_word_idfs_[position]);
+            }
+            if (plus_word_positions != nullptr) {
+                plus_word_positions->push_back(position);
+            }
+        }
+        for (const std::string& word : prepared_query.minus_words_) {
+            if (const TermId term = dictionary_.Find(word); term != TermDictionary::NO_TERM) {
+                query.minus_words.push_back(term);
+            }
+        }
+        std::sort(query.minus_words.begin(), query.minus_words.end());
+        for (const std::string& word : prepared_query.required_words_) {
+            query.required_words.push_back(dictionary_.Find(word));
+        }
+        std::sort(query.required_words.begin(), query.required_words.end());
         return query;
     }
+
+    const SearchServer::Query& SearchServer::ResolveQuery(const PreparedQuery& prepared_query, Query& resolved) const {
+        // The dictionary only grows between compactions, so known words keep
+        // their ids and only unknown ones may have appeared since
+        if (prepared_query.dictionary_id_ == dictionary_id_
+            && (!prepared_query.has_unknown_words_ || prepared_query.dictionary_size_ == dictionary_.size())) {
+            return prepared_query.query_;
+        }
+        resolved = FindQueryTerms(prepared_query);
+        return resolved;
+    }
    
-    double SearchServer::ComputeWordInverseDocumentFreq(std::string_view word) const {
-        return log(document_info_.size() * 1.0 / word_to_document_freqs_.at(word).size());
+    CollectionStatistics SearchServer::GetCollectionStatistics() const {
+        const int document_count = static_cast<int>(document_count_.size());
+        return { document_count, document_count == 0 ? 0.0 : static_cast<double>(total_document_length_) / document_count };
     }
 
-    
-    
-    void SearchServer::CheckValidWord(std::string_view words) {
-        if (std::any_of(words.begin(), words.end(), [](char c) {
-            return c >= '\0' && c < ' '; })) {
-            throw std::invalid_argument("stop_words contains invalid characters"s);
+    void SearchServer::AppendDocumentAttributes(int document_id, DocumentStatus status, int rating, int length) {
+        const int ordinal = static_cast<int>(document_ids_.size());
+        document_count_.insert(document_id);
+        document_ordinals_[document_id] = ordinal;
+        document_ids_.push_back(document_id);
+        document_ratings_.push_back(rating);
+        document_statuses_.push_back(status);
+        document_lengths_.push_back(length);
+        tombstones_.push_back(false);
+        for (size_t bitmap_status = 0; bitmap_status < STATUS_COUNT; ++bitmap_status) {
+            status_bitmaps_[bitmap_status].push_back(static_cast<size_t>(status) == bitmap_status);
         }
+        total_document_length_ += length;
     }
 
-    const std::map<std::string_view, double>& SearchServer::GetWordFrequencies(int document_id) const {
-        static const std::map<std::string_view, double> empty_map = {};
+    void SearchServer::MarkRemoved(int ordinal) {
+        tombstones_[ordinal] = true;
+        for (std::vector<bool>& bitmap : status_bitmaps_) {
+            bitmap[ordinal] = false;
+        }
+        total_document_length_ -= document_lengths_[ordinal];
+    }
 
-        if (!word_frequency_.count(document_id)) {
-            return empty_map;
+    std::vector<std::pair<int, int>> SearchServer::SplitOrdinalRanges(size_t max_range_count) const {
+        const int ordinal_count = static_cast<int>(document_ids_.size());
+        const int range_count = std::max(1, std::min(static_cast<int>(max_range_count), ordinal_count / MIN_ORDINAL_RANGE_SIZE));
+        std::vector<std::pair<int, int>> ranges;
+        for (int range = 0; range < range_count; ++range) {
+            ranges.emplace_back(static_cast<int>(static_cast<int64_t>(ordinal_count) * range / range_count),
+                static_cast<int>(static_cast<int64_t>(ordinal_count) * (range + 1) / range_count));
         }
-        return word_frequency_.at(document_id);
+        return ranges;
+    }
+
+    SearchServer::RangeScratch& SearchServer::GetRangeScratch() {
+        thread_local RangeScratch scratch;
+        return scratch;
+    }
+
+    SearchServer::ImpactScratch& SearchServer::GetImpactScratch() {
+        thread_local ImpactScratch scratch;
+        return scratch;
+    }
+
+    uint32_t SearchServer::GetTermDocumentCount(TermId term) const {
+        return term < term_document_counts_.size() ? term_document_counts_[term] : 0;
+    }
+
+    size_t SearchServer::FindSegment(int ordinal) const {
+        const auto it = std::upper_bound(segments_.begin(), segments_.end(), ordinal,
+            [](int ordinal, const std::shared_ptr<IndexSegment>& segment) {
+                return ordinal < segment->GetFirstOrdinal();
+            });
+        return it - segments_.begin() - 1;
+    }
+
+    bool SearchServer::ContainsTerm(int ordinal, TermId term) const {
+        const PostingList* postings = segments_[FindSegment(ordinal)]->FindPostings(term);
+        return postings != nullptr && postings->Contains(ordinal);
     }
 
-    void SearchServer::VectorEraseDuplicate(const std::execution::sequenced_policy, std::vector<std::string_view>& vec) const {
+    void SearchServer::SealMutableSegment() {
+        const int end_ordinal = static_cast<int>(document_ids_.size());
+        segments_.back()->Seal(end_ordinal);
+        if (impact_ordered_) {
+            segments_.back()->BuildImpactPostings();
+        }
+        segments_.push_back(std::make_shared<IndexSegment>(end_ordinal));
+        StartSegmentMerge();
+    }
+
+    void SearchServer::StartSegmentMerge() {
+        if (segment_merge_.result.valid()) {
+            return;
+        }
+        // Only the newest sealed segments are candidates: they are the
+        // smallest, and merging neighbours keeps ordinal ranges contiguous
+        const size_t sealed_count = segments_.size() - 1;
+        if (sealed_count < SEGMENT_MERGE_FACTOR) {
+            return;
+        }
+        const size_t first_segment = sealed_count - SEGMENT_MERGE_FACTOR;
+        const auto ordinal_count = [](const IndexSegment& segment) {
+            return static_cast<size_t>(segment.GetEndOrdinal() - segment.GetFirstOrdinal());
+        };
+        if (ordinal_count(*segments_[first_segment]) >= ordinal_count(*segments_[sealed_count - 1]) * SEGMENT_MERGE_FACTOR) {
+            return;
+        }
+        std::vector<std::shared_ptr<const IndexSegment>> inputs(segments_.begin() + first_segment, segments_.begin() + sealed_count);
+        segment_merge_.first_segment = first_segment;
+        segment_merge_.result = std::async(std::launch::async,
+            [inputs = std::move(inputs), tombstones = tombstones_]() {
+                return IndexSegment::Merge(inputs, tombstones);
+            });
+    }
+
+    void SearchServer::FinishSegmentMerge(bool wait) {
+        while (segment_merge_.result.valid()) {
+            if (!wait && segment_merge_.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                return;
+            }
+            std::shared_ptr<IndexSegment> merged = segment_merge_.result.get();
+            const auto first = segments_.begin() + segment_merge_.first_segment;
+            segments_.erase(first + 1, first + SEGMENT_MERGE_FACTOR);
+            segments_[segment_merge_.first_segment] = std::move(merged);
+            StartSegmentMerge();
+        }
+    }
+
+    std::map<std::string_view, double> SearchServer::GetWordFrequencies(int document_id) const {
+        std::map<std::string_view, double> word_frequencies;
+
+        const auto it = document_ordinals_.find(document_id);
+        if (it == document_ordinals_.end()) {
+            return word_frequencies;
+        }
+        for (const auto& [word, term_freq] : word_frequency_[it->second]) {
+            word_frequencies.emplace(dictionary_.GetTerm(word), term_freq);
+        }
+        return word_frequencies;
+    }
+
+    void SearchServer::VectorEraseDuplicate(const std::execution::sequenced_policy, std::vector<TermId>& vec) const {
         std::sort(vec.begin(), vec.end());
         auto last = std::unique(vec.begin(), vec.end());
         vec.erase(last, vec.end());
-    }
-    void SearchServer::VectorEraseDuplicate(const std::execution::parallel_policy, std::vector<std::string_view>& vec) const {
-        std::sort(std::execution::par,vec.begin(), vec.end());
-        auto last = std::unique(std::execution::par, vec.begin(), vec.end());
-        vec.erase(last, vec.end());
     }
\ No newline at end of file
@@ -8,9 +8,28 @@
 #include <execution>
 #include <algorithm>
 #include <deque>
+#include <unordered_map>
+#include <climits>
+#include <limits>
+#include <memory>
+#include <future>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <array>
+#include <type_traits>
 
 #include "document.h"
-#include "concurrent_map.h"
+#include "document_filter.h"
+#include "index_segment.h"
+#include "index_snapshot.h"
+#include "posting_intersection.h"
+#include "posting_list.h"
+#include "query_cache.h"
+#include "query_executor.h"
+#include "scoring.h"
+#include "term_dictionary.h"
+#include "top_documents.h"
 
 using std::string_literals::operator""s;
 
@@ -18,229 +37,1028 @@ const int MAX_RESULT_DOCUMENT_COUNT = 5;
 
 class SearchServer {
 public:
+    class PreparedQuery;
+
+    struct BatchDocument {
+        int document_id;
+        std::string_view text;
+        DocumentStatus status;
+        std::vector<int> ratings;
+    };
+
     SearchServer();
     explicit SearchServer(std::string_view stop_words);
     explicit SearchServer(const std::string& stop_words);
     template <typename Collection> 
     explicit SearchServer(const Collection& stop_words);
+    // A copy shares nothing with the original: segments are deep-copied as
+    // they are now, a merge running in the original stays with it, the
+    // query cache starts empty and prepared queries are resolved again
+    SearchServer(const SearchServer& other);
+    SearchServer& operator=(const SearchServer& other);
+    SearchServer(SearchServer&&) = default;
+    SearchServer& operator=(SearchServer&&) = default;
 
     void AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+    // Tokenizes the batch on all cores into per-thread partial indexes and
+    // merges them into the index in one pass; either all documents are
+    // added or, if any of them is invalid, none
+    void AddDocuments(const std::vector<BatchDocument>& documents);
     void RemoveDocument(int document_id);
     void RemoveDocument(std::execution::sequenced_policy,int document_id);
     void RemoveDocument(std::execution::parallel_policy, int document_id);
+    // Purges postings and attributes of removed documents, numbering the
+    // live ones densely again, drops terms that no document uses any more
+    // and releases their text in bulk. Invalidates string_views returned by MatchDocument and GetWordFrequencies
+    void Compact();
+    // Keeps impact-ordered copies of the postings of sealed segments, with
+    // term frequencies quantized to 16 bits. Top-K queries score those
+    // segments a group of equal impacts at a time and stop once the groups
+    // left cannot change the result; the copies cost memory and time at
+    // every seal, merge and compaction
+    void SetImpactOrdered(bool impact_ordered);
+
+    // Writes the dictionary, postings, forward index and document attributes
+    // to a versioned binary file
+    void SaveSnapshot(const std::string& path) const;
+    // Maps a snapshot file into memory; term text is served from the
+    // mapping, the other arrays are bulk-copied without re-tokenizing
+    static SearchServer OpenSnapshot(const std::string& path);
 
 
     std::set<int>::const_iterator begin() const;
     std::set<int>::const_iterator end() const;
 
+    // Query syntax: a word matches documents containing it and adds to their
+    // relevance, "-word" excludes the documents containing it, and "+word"
+    // both scores and is required, so only documents containing every
+    // required word are found
+    //
+    // Splits and validates the query once and resolves its words to term
+    // ids; the result can be run any number of times. Term ids are looked up
+    // again only after Compact renumbers them, after words unknown at
+    // preparation time may have been added, or on another server
+    PreparedQuery PrepareQuery(std::string_view raw_query) const;
+
     std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(std::string_view raw_query, int document_id) const;
     std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(const std::execution::sequenced_policy, std::string_view raw_query, int document_id) const;
     std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(const std::execution::parallel_policy,  std::string_view raw_query, int document_id) const;
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(const PreparedQuery& prepared_query, int document_id) const;
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(const std::execution::sequenced_policy, const PreparedQuery& prepared_query, int document_id) const;
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(const std::execution::parallel_policy, const PreparedQuery& prepared_query, int document_id) const;
 
-    std::vector<Document> FindTopDocuments( std::string_view raw_query, DocumentStatus status_document) const;
+    // top_k limits the number of returned documents for this call only
+    std::vector<Document> FindTopDocuments( std::string_view raw_query, DocumentStatus status_document, size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
     std::vector<Document> FindTopDocuments(std::string_view raw_query) const;
     template <typename DocumentPredicate>
-    std::vector<Document> FindTopDocuments( std::string_view raw_query, DocumentPredicate document_predicate) const;
+    std::vector<Document> FindTopDocuments( std::string_view raw_query, DocumentPredicate document_predicate, size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
     template <typename ExecutionPolicy>
-    std::vector<Document> FindTopDocuments(const ExecutionPolicy& policy, std::string_view raw_query, DocumentStatus status_document) const;
+    std::vector<Document> FindTopDocuments(const ExecutionPolicy& policy, std::string_view raw_query, DocumentStatus status_document, size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
     template <typename ExecutionPolicy>
     std::vector<Document> FindTopDocuments(const ExecutionPolicy& policy, std::string_view raw_query) const;
     template <typename DocumentPredicate, typename ExecutionPolicy>
-    std::vector<Document> FindTopDocuments(const ExecutionPolicy& policy, std::string_view raw_query, DocumentPredicate document_predicate) const;
+    std::vector<Document> FindTopDocuments(const ExecutionPolicy& policy, std::string_view raw_query, DocumentPredicate document_predicate, size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+    // Queries touching many postings are split over ordinal ranges scored
+    // on the executor's workers, smaller ones run on the calling thread
+    std::vector<Document> FindTopDocuments(QueryExecutor& executor, std::string_view raw_query, DocumentStatus status_document = DocumentStatus::ACTUAL, size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(QueryExecutor& executor, std::string_view raw_query, DocumentPredicate document_predicate, size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(const PreparedQuery& prepared_query, DocumentStatus status_document = DocumentStatus::ACTUAL, size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(const PreparedQuery& prepared_query, DocumentPredicate document_predicate, size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+    template <typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(const ExecutionPolicy& policy, const PreparedQuery& prepared_query, DocumentStatus status_document = DocumentStatus::ACTUAL, size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+    template <typename DocumentPredicate, typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(const ExecutionPolicy& policy, const PreparedQuery& prepared_query, DocumentPredicate document_predicate, size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+    std::vector<Document> FindTopDocuments(QueryExecutor& executor, const PreparedQuery& prepared_query, DocumentStatus status_document = DocumentStatus::ACTUAL, size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(QueryExecutor& executor, const PreparedQuery& prepared_query, DocumentPredicate document_predicate, size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+    // Ranks with a scoring policy such as Bm25Scoring instead of TF-IDF.
+    // Results are not cached, and impact-ordered postings only serve TF-IDF
+    template <typename Scoring, typename DocumentPredicate>
+    std::vector<Document> FindTopDocumentsScored(const Scoring& scoring, std::string_view raw_query, DocumentPredicate document_predicate, size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+    template <typename Scoring>
+    std::vector<Document> FindTopDocumentsScored(const Scoring& scoring, std::string_view raw_query, DocumentStatus status_document = DocumentStatus::ACTUAL, size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
 
 
     int GetDocumentCount() const;
-    const std::map<std::string_view, double>& GetWordFrequencies(int document_id) const;
+    // Ordinals the attribute columns hold, those of removed documents
+    // included until Compact drops them
+    int GetOrdinalCount() const;
+    QueryCacheStats GetQueryCacheStats() const;
+    // Number of documents containing the word
+    int GetDocumentFrequency(std::string_view word) const;
+    std::map<std::string_view, double> GetWordFrequencies(int document_id) const;
 
 private:
 
-    struct DocumentInfo {
-        int rating;
-        DocumentStatus status;
-    };
     struct QueryWord {
         std::string_view data;
+        TermId term;
         bool is_minus;
+        bool is_required;
         bool is_stop;
     };
     struct Query {
-        std::vector<std::string_view> plus_words;
-        std::vector<std::string_view> minus_words;
+        std::vector<TermId> plus_words;
+        std::vector<TermId> minus_words;
+        // Subset of the plus words every found document contains; NO_TERM
+        // stands for a required word no document contains
+        std::vector<TermId> required_words;
+        // Idf of every plus word when it is given by the caller, empty when
+        // the server computes it from its own documents
+        std::vector<double> plus_word_idfs;
     };
     
-    std::deque<std::string> storage;
-    std::set<std::string, std::less<>> stop_words_;
-    std::map<std::string_view, std::map<int, double>> word_to_document_freqs_;
+    // Segments are sealed after this many documents and merged in groups of
+    // SEGMENT_MERGE_FACTOR neighbours of the same size
+    static constexpr int SEGMENT_SEAL_DOCUMENT_COUNT = 4096;
+    static constexpr size_t SEGMENT_MERGE_FACTOR = 4;
+    // Smallest range of ordinals worth scoring as a separate task, and the
+    // number of postings that makes a query worth splitting into ranges
+    static constexpr int MIN_ORDINAL_RANGE_SIZE = 1024;
+    static constexpr size_t PARALLEL_QUERY_MIN_POSTING_COUNT = 1 << 16;
+    static constexpr size_t QUERY_CACHE_CAPACITY = 1024;
+    static constexpr size_t STATUS_COUNT = DocumentStatus::REMOVED + 1;
+
+    enum class Match : uint8_t { NONE, PLUS, MINUS };
+    // Dense buffers for scoring one ordinal range, one set per thread
+    struct RangeScratch {
+        std::vector<double> relevances;
+        std::vector<Match> matches;
+    };
+    enum class Accumulator : uint8_t { UNSEEN, REJECTED, ACCEPTED, IN_TOP };
+    // Accumulators of score-at-a-time evaluation, one set per thread; the
+    // entries listed in touched are reset before the next use
+    struct ImpactScratch {
+        std::vector<double> lower_bounds;
+        std::vector<Accumulator> states;
+        std::vector<int> touched;
+        // Offsets whose bounds still reach the threshold, rescored in order
+        std::vector<int> rescored;
+        // Min-heap of the best accumulators as (lower bound, offset)
+        std::vector<std::pair<double, int>> top;
+    };
+
+    struct SegmentMerge {
+        size_t first_segment;
+        std::future<std::shared_ptr<IndexSegment>> result;
+    };
+
+    TermDictionary dictionary_;
+    // Identifies the term numbering of dictionary_ for prepared queries;
+    // unique among servers and renewed by Compact
+    uint64_t dictionary_id_ = NextDictionaryId();
+    std::vector<bool> stop_terms_;
+    // Postings live in segments over consecutive ordinal ranges; the last
+    // segment is the mutable one new documents go to, the others are sealed
+    std::vector<std::shared_ptr<IndexSegment>> segments_ = { std::make_shared<IndexSegment>(0) };
+    SegmentMerge segment_merge_;
+    // Number of documents containing each term over all segments, for idf
+    std::vector<uint32_t> term_document_counts_;
     std::set<int> document_count_;
-    std::map<int, DocumentInfo> document_info_;
-    std::map<int, std::map<std::string_view, double>> word_frequency_;
+    // Postings refer to documents by dense ordinals assigned in insertion
+    // order; document attributes are columns indexed by the ordinal
+    std::unordered_map<int, int> document_ordinals_;
+    std::vector<int> document_ids_;
+    std::vector<int> document_ratings_;
+    std::vector<DocumentStatus> document_statuses_;
+    // Number of non-stop words, for length normalization
+    std::vector<int> document_lengths_;
+    uint64_t total_document_length_ = 0;
+    // Removed documents keep their ordinals and postings until Compact,
+    // queries skip the ordinals marked here
+    std::vector<bool> tombstones_;
+    // Live ordinals of every status, so a StatusFilter costs one bit test
+    std::array<std::vector<bool>, STATUS_COUNT> status_bitmaps_;
+    std::vector<std::vector<std::pair<TermId, double>>> word_frequency_;
+    std::shared_ptr<const MappedFile> snapshot_file_;
+    // Bumped by every update, so cached results of older versions miss
+    uint64_t generation_ = 0;
+    std::unique_ptr<QueryCache> query_cache_ = std::make_unique<QueryCache>(QUERY_CACHE_CAPACITY);
+    bool impact_ordered_ = false;
 
-    bool IsStopWord(std::string_view word) const;
-    std::vector<std::string_view> SplitIntoWordsNoStop( std::string_view text) const;
+    static uint64_t NextDictionaryId();
+    void AddStopWord(std::string_view word);
+    bool IsStopWord(TermId term) const;
+    std::vector<TermId> SplitIntoTermsNoStop(std::string_view text);
 
     static int ComputeAverageRating(const std::vector<int>& ratings);
-    double ComputeWordInverseDocumentFreq(std::string_view word) const;
+    static std::vector<Document> SelectTopDocuments(const std::vector<Document>& matched_documents, size_t top_k);
+    uint32_t GetTermDocumentCount(TermId term) const;
+    CollectionStatistics GetCollectionStatistics() const;
+    void AppendDocumentAttributes(int document_id, DocumentStatus status, int rating, int length);
+    void MarkRemoved(int ordinal);
+    // Drops the ordinals of removed documents and numbers the live ones
+    // densely again, in the columns and in the segments alike
+    void RenumberOrdinals();
+    // Whether the document is live and passes the predicate; filters of
+    // known shapes are answered from the attribute columns
+    template <typename DocumentPredicate>
+    bool IsAccepted(DocumentPredicate& predicat, int ordinal) const;
+
+    size_t FindSegment(int ordinal) const;
+    bool ContainsTerm(int ordinal, TermId term) const;
+    void SealMutableSegment();
+    void StartSegmentMerge();
+    void FinishSegmentMerge(bool wait);
+
+    template <typename Scorer>
+    std::vector<std::pair<TermId, double>> GetPlusWordWeights(const Query& query, const Scorer& scorer) const;
+    std::vector<std::pair<int, int>> SplitOrdinalRanges(size_t max_range_count) const;
+    static RangeScratch& GetRangeScratch();
+    static ImpactScratch& GetImpactScratch();
 
     QueryWord ParseQueryWord(std::string_view text) const;
-    Query ParseQuery(const bool Need_parallel_version, std::string_view text) const;
-    template <typename DocumentPredicate>
-    std::vector<Document> FindAllDocuments(const Query& query, DocumentPredicate& predicat) const;
-    template <typename DocumentPredicate>
-    std::vector<Document> FindAllDocuments(const std::execution::sequenced_policy, const Query& query, DocumentPredicate& predicat) const;
+    Query ParseQuery(std::string_view text) const;
+    // Also lists, when asked, where each resolved plus term stands among the
+    // plus words of the prepared query
+    Query FindQueryTerms(const PreparedQuery& prepared_query, std::vector<size_t>* plus_word_positions = nullptr) const;
+    // Term ids of the prepared query for this server: its own ones while
+    // they are current, otherwise looked up again into `resolved`
+    const Query& ResolveQuery(const PreparedQuery& prepared_query, Query& resolved) const;
+    template <typename ExecutionPolicy>
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(const ExecutionPolicy& policy, const Query& query, int document_id) const;
+    template <typename DocumentPredicate, typename Scoring = TfIdfScoring>
+    std::vector<Document> FindTopDocuments(const std::execution::sequenced_policy, const Query& query, DocumentPredicate& predicat, size_t top_k, const Scoring& scoring = Scoring()) const;
+    template <typename DocumentPredicate, typename Scoring = TfIdfScoring>
+    std::vector<Document> FindTopDocuments(const std::execution::parallel_policy, const Query& query, DocumentPredicate& predicat, size_t top_k, const Scoring& scoring = Scoring()) const;
+    template <typename DocumentPredicate, typename Scoring = TfIdfScoring>
+    std::vector<Document> FindTopDocuments(QueryExecutor& executor, const Query& query, DocumentPredicate& predicat, size_t top_k, const Scoring& scoring = Scoring()) const;
+    template <typename ExecutionPolicy>
+    std::vector<Document> FindTopDocumentsCached(ExecutionPolicy& policy, const Query& query, DocumentStatus status_document, size_t top_k) const;
+    template <typename DocumentPredicate, typename Scorer>
+    std::vector<Document> FindTopDocumentsMaxScore(const Query& query, DocumentPredicate& predicat, size_t top_k, const Scorer& scorer) const;
+    template <typename DocumentPredicate, typename Scorer>
+    void FindTopDocumentsMaxScore(const IndexSegment& segment, const std::vector<std::pair<TermId, double>>& plus_words, const std::vector<TermId>& minus_words,
+        DocumentPredicate& predicat, const Scorer& scorer, TopDocuments& top_documents) const;
+    template <typename DocumentPredicate, typename Scorer>
+    std::vector<Document> FindTopDocumentsConjunctive(const Query& query, DocumentPredicate& predicat, size_t top_k, const Scorer& scorer) const;
     template <typename DocumentPredicate>
-    std::vector<Document> FindAllDocuments(const std::execution::parallel_policy, const Query& query, DocumentPredicate& predicat) const;
+    void FindTopDocumentsImpactOrdered(const IndexSegment& segment, const std::vector<std::pair<TermId, double>>& plus_words, const std::vector<TermId>& minus_words,
+        DocumentPredicate& predicat, size_t top_k, TopDocuments& top_documents) const;
+    template <typename DocumentPredicate, typename Scorer>
+    std::vector<Document> FindAllDocuments(const Query& query, DocumentPredicate& predicat, const Scorer& scorer) const;
+    template <typename DocumentPredicate, typename Scorer>
+    std::vector<Document> FindAllDocuments(const std::execution::parallel_policy, const Query& query, DocumentPredicate& predicat, const Scorer& scorer) const;
+    template <typename DocumentPredicate, typename Scorer, typename Consumer>
+    void ScoreOrdinalRange(const std::vector<std::pair<TermId, double>>& plus_words, const std::vector<TermId>& minus_words, DocumentPredicate& predicat,
+        const Scorer& scorer, int first, int end, Consumer consumer) const;
 
-    static void CheckValidWord(std::string_view words);
     template <typename Collection>
     static void CheckValidWord(const Collection& words);
 
-    void VectorEraseDuplicate(const std::execution::sequenced_policy, std::vector<std::string_view>& vec) const;
-    void VectorEraseDuplicate(const std::execution::parallel_policy, std::vector<std::string_view>& vec) const;
+    void VectorEraseDuplicate(const std::execution::sequenced_policy, std::vector<TermId>& vec) const;
     
 };
 
+class SearchServer::PreparedQuery {
+public:
+    const std::vector<std::string>& GetPlusWords() const;
+    // Scores the plus words with these idfs, given in GetPlusWords order,
+    // instead of the ones of the server running the query, so that servers
+    // holding parts of one collection rank their documents alike. Negative
+    // or NaN idfs are rejected
+    void SetInverseDocumentFreqs(std::vector<double> inverse_document_freqs);
+
+private:
+    friend class SearchServer;
+
+    // Deduplicated text of the non-stop words, kept to look them up again
+    std::vector<std::string> plus_words_;
+    std::vector<std::string> minus_words_;
+    // Also listed among the plus words
+    std::vector<std::string> required_words_;
+    // Idfs given by the caller, in plus_words_ order; empty when the server
+    // running the query computes its own
+    std::vector<double> plus_word_idfs_;
+    Query query_;
+    // Index into plus_words_ of every plus term of query_
+    std::vector<size_t> plus_word_positions_;
+    // Numbering query_ was resolved against
+    uint64_t dictionary_id_ = 0;
+    size_t dictionary_size_ = 0;
+    bool has_unknown_words_ = false;
+};
+
 
 
 template <typename Collection>
 SearchServer::SearchServer(const Collection& stop_words)
 {
     CheckValidWord(stop_words);
-    for (const std::string_view& word : stop_words) {
-        stop_words_.insert(std::string(word));
+    for (const std::string_view word : stop_words) {
+        AddStopWord(word);
     }
 }
 
 template <typename DocumentPredicate>
-std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate) const {
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate, size_t top_k) const {
 
 
-    Query query = ParseQuery(false,raw_query);
+    Query query = ParseQuery(raw_query);
     
-    auto matched_documents = FindAllDocuments(query, document_predicate);
-
-    sort(matched_documents.begin(), matched_documents.end(),
-        [](const Document& lhs, const Document& rhs) {
-            const double EPSILON = 1e-6;
-            return lhs.relevance > rhs.relevance || ((std::abs(lhs.relevance - rhs.relevance) < EPSILON) && lhs.rating > rhs.rating);
-        });
-    if (matched_documents.size() > MAX_RESULT_DOCUMENT_COUNT) {
-        matched_documents.resize(MAX_RESULT_DOCUMENT_COUNT);
-    }
-    std::vector<Document> result = matched_documents;
-    return result;
+    return FindTopDocuments(std::execution::seq, query, document_predicate, top_k);
 }
 
 template <typename ExecutionPolicy>
-std::vector<Document> SearchServer::FindTopDocuments(const ExecutionPolicy& policy, std::string_view raw_query, DocumentStatus status_document) const {
-    return FindTopDocuments(policy, raw_query, [status_document](int document_id, DocumentStatus status, int rating) { return  status == status_document; });
+std::vector<Document> SearchServer::FindTopDocuments(const ExecutionPolicy& policy, std::string_view raw_query, DocumentStatus status_document, size_t top_k) const {
+    return FindTopDocumentsCached(policy, ParseQuery(raw_query), status_document, top_k);
 }
 
 template <typename ExecutionPolicy>
 std::vector<Document> SearchServer::FindTopDocuments(const ExecutionPolicy& policy, std::string_view raw_query) const {
-    DocumentStatus status_document = DocumentStatus::ACTUAL;
-    return FindTopDocuments(policy, raw_query, [status_document](int document_id, DocumentStatus status, int rating) { return  status == status_document; });
+    return FindTopDocumentsCached(policy, ParseQuery(raw_query), DocumentStatus::ACTUAL, MAX_RESULT_DOCUMENT_COUNT);
 }
 
-template <typename DocumentPredicate, typename ExecutionPolicy>
-std::vector<Document> SearchServer::FindTopDocuments(const ExecutionPolicy& policy, std::string_view raw_query, DocumentPredicate document_predicate) const {
+template <typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocuments(const PreparedQuery& prepared_query, DocumentPredicate document_predicate, size_t top_k) const {
+    return FindTopDocuments(std::execution::seq, prepared_query, document_predicate, top_k);
+}
 
-    Query query = ParseQuery( false, raw_query);
+template <typename ExecutionPolicy>
+std::vector<Document> SearchServer::FindTopDocuments(const ExecutionPolicy& policy, const PreparedQuery& prepared_query, DocumentStatus status_document, size_t top_k) const {
+    Query resolved;
+    return FindTopDocumentsCached(policy, ResolveQuery(prepared_query, resolved), status_document, top_k);
+}
 
-    auto matched_documents = FindAllDocuments(policy, query, document_predicate);
+template <typename DocumentPredicate, typename ExecutionPolicy>
+std::vector<Document> SearchServer::FindTopDocuments(const ExecutionPolicy& policy, const PreparedQuery& prepared_query, DocumentPredicate document_predicate, size_t top_k) const {
+    Query resolved;
+    return FindTopDocuments(policy, ResolveQuery(prepared_query, resolved), document_predicate, top_k);
+}
+
+template <typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocuments(QueryExecutor& executor, const PreparedQuery& prepared_query, DocumentPredicate document_predicate, size_t top_k) const {
+    Query resolved;
+    return FindTopDocuments(executor, ResolveQuery(prepared_query, resolved), document_predicate, top_k);
+}
 
-    sort(matched_documents.begin(), matched_documents.end(),
-        [](const Document& lhs, const Document& rhs) {
-            const double EPSILON = 1e-6;
-            return lhs.relevance > rhs.relevance || ((std::abs(lhs.relevance - rhs.relevance) < EPSILON) && lhs.rating > rhs.rating);
+template <typename ExecutionPolicy>
+std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(const ExecutionPolicy& policy, const Query& query, int document_id) const {
+    const int ordinal = document_ordinals_.at(document_id);
+    const DocumentStatus status = document_statuses_[ordinal];
+    const auto contains = [this, ordinal](const TermId word) { return ContainsTerm(ordinal, word); };
+    if (std::any_of(policy, query.minus_words.begin(), query.minus_words.end(), contains)
+        || !std::all_of(policy, query.required_words.begin(), query.required_words.end(), contains)) {
+        return { std::vector<std::string_view>(), status };
+    }
+    // Plus words are already unique, so no deduplication is needed here
+    std::vector<TermId> matched_terms(query.plus_words.size());
+    matched_terms.erase(std::copy_if(policy, query.plus_words.begin(), query.plus_words.end(), matched_terms.begin(), contains), matched_terms.end());
+    std::vector<std::string_view> matched_words(matched_terms.size());
+    std::transform(matched_terms.begin(), matched_terms.end(), matched_words.begin(),
+        [this](const TermId word)
+        {
+            return dictionary_.GetTerm(word);
         });
-    if (matched_documents.size() > MAX_RESULT_DOCUMENT_COUNT) {
-        matched_documents.resize(MAX_RESULT_DOCUMENT_COUNT);
+    std::sort(matched_words.begin(), matched_words.end());
+    return { matched_words, status };
+}
+
+// Only status queries are cached: a predicate cannot be compared with the
+// one an entry was computed for. Neither are queries with idfs given by the
+// caller, whose results depend on more than this server's documents
+template <typename ExecutionPolicy>
+std::vector<Document> SearchServer::FindTopDocumentsCached(ExecutionPolicy& policy, const Query& query, DocumentStatus status_document, size_t top_k) const {
+    StatusFilter predicate{ status_document };
+    if (!query.plus_word_idfs.empty()) {
+        return FindTopDocuments(policy, query, predicate, top_k);
     }
-    std::vector<Document> result = matched_documents;
-    return result;
+    const QueryCache::Key key{ query.plus_words, query.minus_words, query.required_words, status_document, top_k };
+    if (std::optional<std::vector<Document>> documents = query_cache_->Find(key, generation_)) {
+        return *documents;
+    }
+    std::vector<Document> documents = FindTopDocuments(policy, query, predicate, top_k);
+    query_cache_->Insert(key, generation_, documents);
+    return documents;
 }
 
+template <typename DocumentPredicate, typename ExecutionPolicy>
+std::vector<Document> SearchServer::FindTopDocuments(const ExecutionPolicy& policy, std::string_view raw_query, DocumentPredicate document_predicate, size_t top_k) const {
 
+    Query query = ParseQuery(raw_query);
+
+    return FindTopDocuments(policy, query, document_predicate, top_k);
+}
+
+template <typename Scoring, typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocumentsScored(const Scoring& scoring, std::string_view raw_query, DocumentPredicate document_predicate, size_t top_k) const {
+    return FindTopDocuments(std::execution::seq, ParseQuery(raw_query), document_predicate, top_k, scoring);
+}
+
+template <typename Scoring>
+std::vector<Document> SearchServer::FindTopDocumentsScored(const Scoring& scoring, std::string_view raw_query, DocumentStatus status_document, size_t top_k) const {
+    return FindTopDocumentsScored(scoring, raw_query, StatusFilter{ status_document }, top_k);
+}
 
 template <typename DocumentPredicate>
-std::vector<Document> SearchServer::FindAllDocuments(const Query& query, DocumentPredicate& predicat) const {
-    std::map<int, double> document_to_relevance;
-    for (const std::string_view& word : query.plus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
+bool SearchServer::IsAccepted(DocumentPredicate& predicat, int ordinal) const {
+    using Filter = std::remove_cv_t<DocumentPredicate>;
+    if constexpr (std::is_same_v<Filter, StatusFilter>) {
+        return static_cast<size_t>(predicat.status) < STATUS_COUNT && status_bitmaps_[predicat.status][ordinal];
+    }
+    else if constexpr (std::is_same_v<Filter, RatingRange>) {
+        return !tombstones_[ordinal] && document_ratings_[ordinal] >= predicat.min_rating && document_ratings_[ordinal] <= predicat.max_rating;
+    }
+    else {
+        return !tombstones_[ordinal] && predicat(document_ids_[ordinal], document_statuses_[ordinal], document_ratings_[ordinal]);
+    }
+}
+
+template <typename Scorer>
+std::vector<std::pair<TermId, double>> SearchServer::GetPlusWordWeights(const Query& query, const Scorer& scorer) const {
+    std::vector<std::pair<TermId, double>> plus_words;
+    for (size_t i = 0; i < query.plus_words.size(); ++i) {
+        const TermId word = query.plus_words[i];
+        if (const uint32_t document_frequency = GetTermDocumentCount(word); document_frequency > 0) {
+            plus_words.emplace_back(word, query.plus_word_idfs.empty() ? scorer.GetTermWeight(document_frequency) : query.plus_word_idfs[i]);
+        }
+    }
+    return plus_words;
+}
+
+template <typename DocumentPredicate, typename Scoring>
+std::vector<Document> SearchServer::FindTopDocuments(const std::execution::sequenced_policy, const Query& query, DocumentPredicate& predicat, size_t top_k, const Scoring& scoring) const {
+    // Result buffers are sized by top_k, which may be far above the document count
+    top_k = std::min(top_k, document_count_.size());
+    const auto scorer = scoring.GetScorer(GetCollectionStatistics());
+    if (!query.required_words.empty()) {
+        return FindTopDocumentsConjunctive(query, predicat, top_k, scorer);
+    }
+    // Pruning cannot skip anything when every document fits into the result
+    if (top_k >= document_count_.size()) {
+        return SelectTopDocuments(FindAllDocuments(query, predicat, scorer), top_k);
+    }
+    return FindTopDocumentsMaxScore(query, predicat, top_k, scorer);
+}
+
+template <typename DocumentPredicate, typename Scoring>
+std::vector<Document> SearchServer::FindTopDocuments(const std::execution::parallel_policy, const Query& query, DocumentPredicate& predicat, size_t top_k, const Scoring& scoring) const {
+    // Conjunctive queries only touch the rarest list's share of the postings
+    if (!query.required_words.empty()) {
+        return FindTopDocuments(std::execution::seq, query, predicat, top_k, scoring);
+    }
+    top_k = std::min(top_k, document_count_.size());
+    return SelectTopDocuments(FindAllDocuments(std::execution::par, query, predicat, scoring.GetScorer(GetCollectionStatistics())), top_k);
+}
+
+// Document-at-a-time evaluation with MaxScore pruning. Terms are ordered by
+// their score upper bound (max term frequency * idf); once the current top-K
+// threshold exceeds the summed bounds of the weakest terms, those terms stop
+// producing candidates and are only probed for documents that can still
+// enter the result. Block maxima of the probed terms tighten the bound
+// before any posting inside a block is looked at.
+template <typename DocumentPredicate, typename Scorer>
+std::vector<Document> SearchServer::FindTopDocumentsMaxScore(const Query& query, DocumentPredicate& predicat, size_t top_k, const Scorer& scorer) const {
+    if (top_k == 0) {
+        return {};
+    }
+    // Idf is global, so scores and the threshold carry over between segments
+    const std::vector<std::pair<TermId, double>> plus_words = GetPlusWordWeights(query, scorer);
+    // Impacts are quantized TF-IDF term frequencies
+    const bool is_impact_ordered = std::is_same_v<Scorer, TfIdfScoring::Scorer>;
+    TopDocuments top_documents(top_k);
+    for (const std::shared_ptr<IndexSegment>& segment : segments_) {
+        if (is_impact_ordered && segment->HasImpactPostings()) {
+            FindTopDocumentsImpactOrdered(*segment, plus_words, query.minus_words, predicat, top_k, top_documents);
+        }
+        else {
+            FindTopDocumentsMaxScore(*segment, plus_words, query.minus_words, predicat, scorer, top_documents);
+        }
+    }
+    return top_documents.Extract();
+}
+
+template <typename DocumentPredicate, typename Scorer>
+void SearchServer::FindTopDocumentsMaxScore(const IndexSegment& segment, const std::vector<std::pair<TermId, double>>& plus_words, const std::vector<TermId>& minus_words,
+    DocumentPredicate& predicat, const Scorer& scorer, TopDocuments& top_documents) const {
+    struct TermCursor {
+        const PostingList* postings;
+        PostingList::Cursor position;
+        size_t block;
+        double term_weight;
+        double max_score;
+    };
+    const double EPSILON = 1e-6;
+
+    std::vector<TermCursor> cursors;
+    for (const auto& [word, term_weight] : plus_words) {
+        const PostingList* postings = segment.FindPostings(word);
+        if (postings == nullptr || postings->empty()) {
             continue;
         }
-        const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-        for (const auto [document_id, term_freq] : word_to_document_freqs_.at(word)) {
-            if (predicat(document_id, document_info_.at(document_id).status, document_info_.at(document_id).rating)) {
-                document_to_relevance[document_id] += term_freq * inverse_document_freq;
-            }
-            
+        cursors.push_back({ postings, PostingList::Cursor(*postings), 0,
+            term_weight, scorer.GetMaxScore(term_weight, postings->GetMaxTermFreq()) });
+    }
+    std::sort(cursors.begin(), cursors.end(),
+        [](const TermCursor& lhs, const TermCursor& rhs) {
+            return lhs.max_score < rhs.max_score;
+        });
+    // upper_bounds[i] bounds the score a document can get from cursors 0..i
+    std::vector<double> upper_bounds(cursors.size());
+    double bound_sum = 0.0;
+    for (size_t i = 0; i < cursors.size(); ++i) {
+        bound_sum += cursors[i].max_score;
+        upper_bounds[i] = bound_sum;
+    }
+
+    std::vector<PostingList::Cursor> minus_cursors;
+    for (const TermId word : minus_words) {
+        const PostingList* postings = segment.FindPostings(word);
+        if (postings != nullptr) {
+            minus_cursors.emplace_back(*postings);
+        }
+    }
+
+    double threshold = std::numeric_limits<double>::lowest();
+    size_t first_essential = 0;
+    if (top_documents.IsFull()) {
+        threshold = top_documents.GetWorst().relevance;
+        while (first_essential < cursors.size() && upper_bounds[first_essential] < threshold - EPSILON) {
+            ++first_essential;
         }
     }
+    while (true) {
+        int candidate = INT_MAX;
+        for (size_t i = first_essential; i < cursors.size(); ++i) {
+            const TermCursor& cursor = cursors[i];
+            if (!cursor.position.IsAtEnd()) {
+                candidate = std::min(candidate, cursor.position.GetDocumentId());
+            }
+        }
+        if (candidate == INT_MAX) {
+            break;
+        }
 
-    for (const std::string_view& word : query.minus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
+        double relevance = 0.0;
+        for (size_t i = first_essential; i < cursors.size(); ++i) {
+            TermCursor& cursor = cursors[i];
+            if (!cursor.position.IsAtEnd() && cursor.position.GetDocumentId() == candidate) {
+                relevance += scorer.Score(cursor.term_weight, cursor.position.GetTermFreq(), document_lengths_[candidate]);
+                cursor.position.Next();
+            }
+        }
+        if (!IsAccepted(predicat, candidate)) {
+            continue;
+        }
+        // Excluded documents are dropped before the other terms are probed
+        bool excluded = false;
+        for (PostingList::Cursor& cursor : minus_cursors) {
+            cursor.Seek(candidate);
+            if (!cursor.IsAtEnd() && cursor.GetDocumentId() == candidate) {
+                excluded = true;
+                break;
+            }
+        }
+        if (excluded) {
+            continue;
+        }
+
+        bool pruned = false;
+        for (size_t i = first_essential; i-- > 0;) {
+            const double other_bounds = i > 0 ? upper_bounds[i - 1] : 0.0;
+            if (relevance + upper_bounds[i] < threshold - EPSILON) {
+                pruned = true;
+                break;
+            }
+            TermCursor& cursor = cursors[i];
+            const std::vector<PostingList::Block>& blocks = cursor.postings->GetBlocks();
+            cursor.block = cursor.postings->FindBlock(cursor.block, candidate);
+            if (cursor.block == blocks.size()) {
+                continue;
+            }
+            const double block_score = scorer.GetMaxScore(cursor.term_weight, blocks[cursor.block].max_term_freq);
+            if (relevance + block_score + other_bounds < threshold - EPSILON) {
+                pruned = true;
+                break;
+            }
+            cursor.position.Seek(candidate);
+            if (!cursor.position.IsAtEnd() && cursor.position.GetDocumentId() == candidate) {
+                relevance += scorer.Score(cursor.term_weight, cursor.position.GetTermFreq(), document_lengths_[candidate]);
+            }
+        }
+        if (pruned) {
             continue;
         }
-        for (const auto [document_id, _] : word_to_document_freqs_.at(word)) {
-            document_to_relevance.erase(document_id);
+
+        top_documents.Push({ document_ids_[candidate], relevance, document_ratings_[candidate] });
+        if (top_documents.IsFull()) {
+            threshold = top_documents.GetWorst().relevance;
+            while (first_essential < cursors.size() && upper_bounds[first_essential] < threshold - EPSILON) {
+                ++first_essential;
+            }
         }
     }
+}
 
-    std::vector<Document> matched_documents;
-    for (const auto [document_id, relevance] : document_to_relevance) {
-        matched_documents.push_back({
-            document_id,
-            relevance,
-            document_info_.at(document_id).rating
-            });
+// Conjunctive evaluation: the required words' lists of every segment are
+// intersected shortest first, and only the ordinals left are filtered,
+// checked against the minus words and scored; a required NO_TERM has no
+// list, so nothing is found. The other lists are searched by cursors that
+// gallop over the block headers and decode only the block of a candidate,
+// costing about the logarithm of their length per candidate rather than a
+// pass over them.
+template <typename DocumentPredicate, typename Scorer>
+std::vector<Document> SearchServer::FindTopDocumentsConjunctive(const Query& query, DocumentPredicate& predicat, size_t top_k, const Scorer& scorer) const {
+    struct TermCursor {
+        PostingList::Cursor position;
+        double term_weight;
+    };
+    if (top_k == 0) {
+        return {};
     }
-    return matched_documents;
+    const std::vector<std::pair<TermId, double>> plus_words = GetPlusWordWeights(query, scorer);
+    TopDocuments top_documents(top_k);
+    std::vector<const PostingList*> required_postings;
+    std::vector<int> candidates;
+    std::vector<TermCursor> cursors;
+    std::vector<TermCursor> minus_cursors;
+    for (const std::shared_ptr<IndexSegment>& segment : segments_) {
+        required_postings.clear();
+        for (const TermId word : query.required_words) {
+            const PostingList* postings = segment->FindPostings(word);
+            if (postings == nullptr || postings->empty()) {
+                required_postings.clear();
+                break;
+            }
+            required_postings.push_back(postings);
+        }
+        if (required_postings.empty()) {
+            continue;
+        }
+        IntersectPostingLists(required_postings, candidates);
+
+        cursors.clear();
+        for (const auto& [word, term_weight] : plus_words) {
+            if (const PostingList* postings = segment->FindPostings(word)) {
+                cursors.push_back({ PostingList::Cursor(*postings), term_weight });
+            }
+        }
+        minus_cursors.clear();
+        for (const TermId word : query.minus_words) {
+            if (const PostingList* postings = segment->FindPostings(word)) {
+                minus_cursors.push_back({ PostingList::Cursor(*postings), 0.0 });
+            }
+        }
+        // Moves the cursor to the candidate and tells whether the list has it
+        const auto seek = [](TermCursor& cursor, int candidate) {
+            cursor.position.Seek(candidate);
+            return !cursor.position.IsAtEnd() && cursor.position.GetDocumentId() == candidate;
+        };
+        for (const int candidate : candidates) {
+            if (!IsAccepted(predicat, candidate)
+                || std::any_of(minus_cursors.begin(), minus_cursors.end(),
+                    [&seek, candidate](TermCursor& cursor) {
+                        return seek(cursor, candidate);
+                    })) {
+                continue;
+            }
+            double relevance = 0.0;
+            for (TermCursor& cursor : cursors) {
+                if (seek(cursor, candidate)) {
+                    relevance += scorer.Score(cursor.term_weight, cursor.position.GetTermFreq(), document_lengths_[candidate]);
+                }
+            }
+            top_documents.Push({ document_ids_[candidate], relevance, document_ratings_[candidate] });
+        }
+    }
+    return top_documents.Extract();
 }
+
+// Score-at-a-time evaluation over impact-ordered postings. The groups of all
+// terms are taken in decreasing impact * idf order and only add lower bounds
+// of the scores into dense accumulators. Once the groups left cannot lift
+// any document above the top-K threshold, the rest of the postings is
+// skipped, and the documents whose bounds still reach the threshold are
+// rescored exactly from the document-ordered lists.
 template <typename DocumentPredicate>
-std::vector<Document> SearchServer::FindAllDocuments(const std::execution::sequenced_policy, const Query& query, DocumentPredicate& predicat) const {
-    return FindAllDocuments(query,predicat);
+void SearchServer::FindTopDocumentsImpactOrdered(const IndexSegment& segment, const std::vector<std::pair<TermId, double>>& plus_words, const std::vector<TermId>& minus_words,
+    DocumentPredicate& predicat, size_t top_k, TopDocuments& top_documents) const {
+    struct TermCursor {
+        const ImpactPostingList* postings;
+        size_t group;
+        // Score of one impact step of this term
+        double impact_weight;
+    };
+    const double EPSILON = 1e-6;
+
+    std::vector<TermCursor> cursors;
+    std::vector<std::pair<PostingList::Cursor, double>> exact_words;
+    // Largest amount by which the accumulated lower bound of a document can
+    // fall short of its score over the groups already taken
+    double quantization_error = 0.0;
+    for (const auto& [word, inverse_document_freq] : plus_words) {
+        const ImpactPostingList* impact_postings = segment.FindImpactPostings(word);
+        if (impact_postings == nullptr || impact_postings->size() == 0) {
+            continue;
+        }
+        cursors.push_back({ impact_postings, 0, impact_postings->GetImpactUnit() * inverse_document_freq });
+        exact_words.emplace_back(PostingList::Cursor(*segment.FindPostings(word)), inverse_document_freq);
+        quantization_error += cursors.back().impact_weight;
+    }
+    if (cursors.empty()) {
+        return;
+    }
+    std::vector<const PostingList*> minus_postings;
+    for (const TermId word : minus_words) {
+        if (const PostingList* postings = segment.FindPostings(word)) {
+            minus_postings.push_back(postings);
+        }
+    }
+
+    const int first = segment.GetFirstOrdinal();
+    ImpactScratch& scratch = GetImpactScratch();
+    std::vector<double>& lower_bounds = scratch.lower_bounds;
+    std::vector<Accumulator>& states = scratch.states;
+    std::vector<int>& touched = scratch.touched;
+    std::vector<int>& rescored = scratch.rescored;
+    std::vector<std::pair<double, int>>& top = scratch.top;
+    for (const int offset : touched) {
+        lower_bounds[offset] = 0.0;
+        states[offset] = Accumulator::UNSEEN;
+    }
+    touched.clear();
+    top.clear();
+    const size_t ordinal_count = static_cast<size_t>(segment.GetEndOrdinal() - first);
+    if (lower_bounds.size() < ordinal_count) {
+        lower_bounds.resize(ordinal_count, 0.0);
+        states.resize(ordinal_count, Accumulator::UNSEEN);
+    }
+
+    // Highest score a document can still gain from the groups left
+    const auto find_remaining_bound = [&cursors]() {
+        double bound = 0.0;
+        for (const TermCursor& cursor : cursors) {
+            const std::vector<ImpactPostingList::Group>& groups = cursor.postings->GetGroups();
+            if (cursor.group < groups.size()) {
+                bound += groups[cursor.group].impact * cursor.impact_weight;
+            }
+        }
+        return bound;
+    };
+    // Heap entries go stale when their document gains more, which only
+    // leaves them too low; the minimum is brought up to date on demand
+    const auto refresh_top = [&lower_bounds, &top]() {
+        while (!top.empty() && top.front().first < lower_bounds[top.front().second]) {
+            std::pop_heap(top.begin(), top.end(), std::greater<>());
+            top.back().first = lower_bounds[top.back().second];
+            std::push_heap(top.begin(), top.end(), std::greater<>());
+        }
+    };
+    // The k-th best lower bound, unless the results of earlier segments set a higher bar
+    const auto find_threshold = [&]() {
+        double threshold = top_documents.IsFull() ? top_documents.GetWorst().relevance : std::numeric_limits<double>::lowest();
+        refresh_top();
+        if (top.size() == top_k) {
+            threshold = std::max(threshold, top.front().first);
+        }
+        return threshold;
+    };
+
+    while (true) {
+        TermCursor* best_cursor = nullptr;
+        double best_impact = 0.0;
+        for (TermCursor& cursor : cursors) {
+            const std::vector<ImpactPostingList::Group>& groups = cursor.postings->GetGroups();
+            if (cursor.group < groups.size() && (best_cursor == nullptr || groups[cursor.group].impact * cursor.impact_weight > best_impact)) {
+                best_cursor = &cursor;
+                best_impact = groups[cursor.group].impact * cursor.impact_weight;
+            }
+        }
+        if (best_cursor == nullptr) {
+            break;
+        }
+
+        const std::vector<ImpactPostingList::Group>& groups = best_cursor->postings->GetGroups();
+        const ImpactPostingList::Group group = groups[best_cursor->group];
+        const uint32_t begin = best_cursor->group == 0 ? 0 : groups[best_cursor->group - 1].end;
+        const double lower_bound = (group.impact - 1) * best_cursor->impact_weight;
+        const int* ordinals = best_cursor->postings->GetDocumentIds().data();
+        for (uint32_t position = begin; position < group.end; ++position) {
+            const int ordinal = ordinals[position];
+            const int offset = ordinal - first;
+            Accumulator& state = states[offset];
+            if (state == Accumulator::UNSEEN) {
+                touched.push_back(offset);
+                const bool is_excluded = !IsAccepted(predicat, ordinal)
+                    || std::any_of(minus_postings.begin(), minus_postings.end(),
+                        [ordinal](const PostingList* postings) {
+                            return postings->Contains(ordinal);
+                        });
+                state = is_excluded ? Accumulator::REJECTED : Accumulator::ACCEPTED;
+            }
+            if (state == Accumulator::REJECTED) {
+                continue;
+            }
+            const double document_bound = lower_bounds[offset] += lower_bound;
+            if (state == Accumulator::IN_TOP) {
+                continue;
+            }
+            if (top.size() < top_k) {
+                top.emplace_back(document_bound, offset);
+                std::push_heap(top.begin(), top.end(), std::greater<>());
+                state = Accumulator::IN_TOP;
+                continue;
+            }
+            if (document_bound > top.front().first) {
+                refresh_top();
+            }
+            if (document_bound > top.front().first) {
+                states[top.front().second] = Accumulator::ACCEPTED;
+                std::pop_heap(top.begin(), top.end(), std::greater<>());
+                top.back() = { document_bound, offset };
+                std::push_heap(top.begin(), top.end(), std::greater<>());
+                state = Accumulator::IN_TOP;
+            }
+        }
+        ++best_cursor->group;
+        if (find_remaining_bound() < find_threshold() - EPSILON) {
+            break;
+        }
+    }
+
+    const double threshold = find_threshold();
+    const double slack = quantization_error + find_remaining_bound();
+    rescored.clear();
+    for (const int offset : touched) {
+        if (states[offset] != Accumulator::REJECTED && lower_bounds[offset] + slack >= threshold - EPSILON) {
+            rescored.push_back(offset);
+        }
+    }
+    // In ordinal order every exact list is read forward by one cursor
+    std::sort(rescored.begin(), rescored.end());
+    for (const int offset : rescored) {
+        const int ordinal = first + offset;
+        double relevance = 0.0;
+        for (auto& [cursor, inverse_document_freq] : exact_words) {
+            cursor.Seek(ordinal);
+            if (!cursor.IsAtEnd() && cursor.GetDocumentId() == ordinal) {
+                relevance += cursor.GetTermFreq() * inverse_document_freq;
+            }
+        }
+        top_documents.Push({ document_ids_[ordinal], relevance, document_ratings_[ordinal] });
+    }
 }
-template <typename DocumentPredicate>
-std::vector<Document> SearchServer::FindAllDocuments(const std::execution::parallel_policy, const Query& query, DocumentPredicate& predicat) const {
-    ConcurrentMap<int, double> document_to_relevance(100);
-    for_each(std::execution::par, query.plus_words.begin(), query.plus_words.end(),
-        [this, &document_to_relevance,&predicat](const std::string_view& word)
-        {
-            if (word_to_document_freqs_.count(word) != 0) {
-                const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-                for (const auto [document_id, term_freq] : word_to_document_freqs_.at(word)) {
-                    if (predicat(document_id, document_info_.at(document_id).status, document_info_.at(document_id).rating)) {
-                        document_to_relevance[document_id].ref_to_value += term_freq * inverse_document_freq;
+
+template <typename DocumentPredicate, typename Scorer>
+std::vector<Document> SearchServer::FindAllDocuments(const Query& query, DocumentPredicate& predicat, const Scorer& scorer) const {
+    // Minus words are resolved first, so excluded documents are never scored
+    std::vector<bool> excluded;
+    if (!query.minus_words.empty()) {
+        excluded.resize(document_ids_.size(), false);
+        for (const TermId word : query.minus_words) {
+            for (const std::shared_ptr<IndexSegment>& segment : segments_) {
+                if (const PostingList* postings = segment->FindPostings(word)) {
+                    for (PostingList::Cursor cursor(*postings); !cursor.IsAtEnd(); cursor.Next()) {
+                        excluded[cursor.GetDocumentId()] = true;
                     }
                 }
             }
-        });
-
-    for_each(std::execution::par, query.minus_words.begin(), query.minus_words.end(),
-        [this, &document_to_relevance](const std::string_view& word)
-        {
-            if (word_to_document_freqs_.count(word) != 0) {
-                for (const auto [document_id, _] : word_to_document_freqs_.at(word)) {
-                    document_to_relevance.erase(document_id);
+        }
+    }
+    std::map<int, double> document_to_relevance;
+    for (const auto& [word, term_weight] : GetPlusWordWeights(query, scorer)) {
+        for (const std::shared_ptr<IndexSegment>& segment : segments_) {
+            const PostingList* postings = segment->FindPostings(word);
+            if (postings == nullptr) {
+                continue;
+            }
+            for (PostingList::Cursor cursor(*postings); !cursor.IsAtEnd(); cursor.Next()) {
+                const int ordinal = cursor.GetDocumentId();
+                if ((excluded.empty() || !excluded[ordinal]) && IsAccepted(predicat, ordinal)) {
+                    document_to_relevance[ordinal] += scorer.Score(term_weight, cursor.GetTermFreq(), document_lengths_[ordinal]);
                 }
             }
-        });
+        }
+    }
 
     std::vector<Document> matched_documents;
-    for (const auto [document_id, relevance] : document_to_relevance.BuildOrdinaryMap()) {
+    for (const auto& [ordinal, relevance] : document_to_relevance) {
         matched_documents.push_back({
-            document_id,
+            document_ids_[ordinal],
             relevance,
-            document_info_.at(document_id).rating
+            document_ratings_[ordinal]
             });
     }
     return matched_documents;
 }
+// The ordinal space is split into ranges scored independently: every task
+// accumulates into its own dense arrays, so no posting takes a lock, and the
+// ranges are concatenated in ordinal order at the end.
+template <typename DocumentPredicate, typename Scorer>
+std::vector<Document> SearchServer::FindAllDocuments(const std::execution::parallel_policy, const Query& query, DocumentPredicate& predicat, const Scorer& scorer) const {
+    const std::vector<std::pair<TermId, double>> plus_words = GetPlusWordWeights(query, scorer);
+    const std::vector<std::pair<int, int>> ranges = SplitOrdinalRanges(4 * std::thread::hardware_concurrency());
+    std::vector<std::vector<Document>> range_documents(ranges.size());
+    std::for_each(std::execution::par, ranges.begin(), ranges.end(),
+        [this, &plus_words, &query, &predicat, &scorer, &ranges, &range_documents](const std::pair<int, int>& range)
+        {
+            std::vector<Document>& matched_documents = range_documents[&range - ranges.data()];
+            ScoreOrdinalRange(plus_words, query.minus_words, predicat, scorer, range.first, range.second,
+                [&matched_documents](const Document& document) {
+                    matched_documents.push_back(document);
+                });
+        });
+
+    std::vector<Document> matched_documents;
+    for (const std::vector<Document>& documents : range_documents) {
+        matched_documents.insert(matched_documents.end(), documents.begin(), documents.end());
+    }
+    return matched_documents;
+}
+
+// Minus words mark their documents first, so plus postings of excluded
+// documents are skipped. Postings only accumulate scores; the filter is
+// applied once per matched document in the final pass, which walks the
+// attribute columns in order.
+template <typename DocumentPredicate, typename Scorer, typename Consumer>
+void SearchServer::ScoreOrdinalRange(const std::vector<std::pair<TermId, double>>& plus_words, const std::vector<TermId>& minus_words, DocumentPredicate& predicat,
+    const Scorer& scorer, int first, int end, Consumer consumer) const {
+    RangeScratch& scratch = GetRangeScratch();
+    std::vector<double>& relevances = scratch.relevances;
+    std::vector<Match>& matches = scratch.matches;
+    relevances.assign(end - first, 0.0);
+    matches.assign(end - first, Match::NONE);
+    // Walks the postings of the word that fall into the range
+    const auto for_each_posting = [first, end](const PostingList& postings, auto action) {
+        PostingList::Cursor cursor(postings);
+        for (cursor.Seek(first); !cursor.IsAtEnd() && cursor.GetDocumentId() < end; cursor.Next()) {
+            action(cursor.GetDocumentId(), cursor.GetTermFreq());
+        }
+    };
+    for (const std::shared_ptr<IndexSegment>& segment : segments_) {
+        if (segment->GetFirstOrdinal() >= end || segment->GetEndOrdinal() <= first) {
+            continue;
+        }
+        for (const TermId word : minus_words) {
+            if (const PostingList* postings = segment->FindPostings(word)) {
+                for_each_posting(*postings, [&](int ordinal, double) {
+                    matches[ordinal - first] = Match::MINUS;
+                });
+            }
+        }
+        for (const auto& [word, term_weight] : plus_words) {
+            if (const PostingList* postings = segment->FindPostings(word)) {
+                for_each_posting(*postings, [&](int ordinal, double term_freq) {
+                    if (matches[ordinal - first] != Match::MINUS) {
+                        relevances[ordinal - first] += scorer.Score(term_weight, term_freq, document_lengths_[ordinal]);
+                        matches[ordinal - first] = Match::PLUS;
+                    }
+                });
+            }
+        }
+    }
+    for (int ordinal = first; ordinal < end; ++ordinal) {
+        if (matches[ordinal - first] == Match::PLUS && IsAccepted(predicat, ordinal)) {
+            consumer(Document{ document_ids_[ordinal], relevances[ordinal - first], document_ratings_[ordinal] });
+        }
+    }
+}
+
+template <typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocuments(QueryExecutor& executor, std::string_view raw_query, DocumentPredicate document_predicate, size_t top_k) const {
+    const Query query = ParseQuery(raw_query);
+    return FindTopDocuments(executor, query, document_predicate, top_k);
+}
+
+template <typename DocumentPredicate, typename Scoring>
+std::vector<Document> SearchServer::FindTopDocuments(QueryExecutor& executor, const Query& query, DocumentPredicate& predicat, size_t top_k, const Scoring& scoring) const {
+    top_k = std::min(top_k, document_count_.size());
+    const auto scorer = scoring.GetScorer(GetCollectionStatistics());
+    const std::vector<std::pair<TermId, double>> plus_words = GetPlusWordWeights(query, scorer);
+    size_t posting_count = 0;
+    for (const auto& [word, term_weight] : plus_words) {
+        posting_count += GetTermDocumentCount(word);
+    }
+    if (posting_count < PARALLEL_QUERY_MIN_POSTING_COUNT || executor.GetWorkerCount() == 0 || !query.required_words.empty()) {
+        return FindTopDocuments(std::execution::seq, query, predicat, top_k, scoring);
+    }
+
+    // Every range keeps its own top, the tops are merged at the end
+    const std::vector<std::pair<int, int>> ranges = SplitOrdinalRanges(4 * executor.GetWorkerCount());
+    std::vector<std::vector<Document>> range_documents(ranges.size());
+    executor.ParallelFor(ranges.size(), [&](size_t range) {
+        TopDocuments top_documents(top_k);
+        ScoreOrdinalRange(plus_words, query.minus_words, predicat, scorer, ranges[range].first, ranges[range].second,
+            [&top_documents](const Document& document) {
+                top_documents.Push(document);
+            });
+        range_documents[range] = top_documents.Extract();
+    });
+    TopDocuments top_documents(top_k);
+    for (const std::vector<Document>& documents : range_documents) {
+        for (const Document& document : documents) {
+            top_documents.Push(document);
+        }
+    }
+    return top_documents.Extract();
+}
 
 template <typename Collection>
 void SearchServer::CheckValidWord(const Collection& words) {
-    for (const std::string_view& word : words) {
+    for (const auto& word : words) {
         if (std::any_of(word.begin(), word.end(), [](char c) {
             return c >= '\0' && c < ' '; })) {
             throw std::invalid_argument("stop_words contains invalid characters"s);
@@ -0,0 +1,93 @@
+#include <cmath>
+
+#include "sharded_search_server.h"
+#include "string_processing.h"
+
+    ShardedSearchServer::ShardedSearchServer(const std::string& stop_words, size_t shard_count)
+        :ShardedSearchServer(SplitIntoWords(std::string_view(stop_words)), shard_count)
+    {}
+
+    void ShardedSearchServer::AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {
+        shards_[GetShardIndex(document_id)].AddDocument(document_id, document, status, ratings);
+    }
+
+    void ShardedSearchServer::AddDocuments(const std::vector<SearchServer::BatchDocument>& documents) {
+        std::vector<std::vector<SearchServer::BatchDocument>> shard_documents(shards_.size());
+        for (const SearchServer::BatchDocument& document : documents) {
+            shard_documents[GetShardIndex(document.document_id)].push_back(document);
+        }
+        // A shard either takes its whole part or none of it; when some shard
+        // rejects its part, the parts already taken by others are removed
+        std::vector<char> is_added(shards_.size(), false);
+        try {
+            executor_.ParallelFor(shards_.size(),
+                [this, &shard_documents, &is_added](size_t shard)
+                {
+                    shards_[shard].AddDocuments(shard_documents[shard]);
+                    is_added[shard] = true;
+                });
+        }
+        catch (...) {
+            for (size_t shard = 0; shard < shards_.size(); ++shard) {
+                if (is_added[shard]) {
+                    for (const SearchServer::BatchDocument& document : shard_documents[shard]) {
+                        shards_[shard].RemoveDocument(document.document_id);
+                    }
+                }
+            }
+            throw;
+        }
+    }
+
+    void ShardedSearchServer::RemoveDocument(int document_id) {
+        shards_[GetShardIndex(document_id)].RemoveDocument(document_id);
+    }
+
+    void ShardedSearchServer::Compact() {
+        executor_.ParallelFor(shards_.size(),
+            [this](size_t shard)
+            {
+                shards_[shard].Compact();
+            });
+    }
+
+    std::vector<Document> ShardedSearchServer::FindTopDocuments(std::string_view raw_query, DocumentStatus status, size_t top_k) const {
+        return FindTopDocuments(raw_query, StatusFilter{ status }, top_k);
+    }
+
+    std::tuple<std::vector<std::string_view>, DocumentStatus> ShardedSearchServer::MatchDocument(std::string_view raw_query, int document_id) const {
+        return shards_[GetShardIndex(document_id)].MatchDocument(raw_query, document_id);
+    }
+
+    int ShardedSearchServer::GetDocumentCount() const {
+        int document_count = 0;
+        for (const SearchServer& shard : shards_) {
+            document_count += shard.GetDocumentCount();
+        }
+        return document_count;
+    }
+
+    size_t ShardedSearchServer::GetShardCount() const {
+        return shards_.size();
+    }
+
+    size_t ShardedSearchServer::GetShardIndex(int document_id) const {
+        // Negative ids still map to some shard, which rejects or ignores them
+        return static_cast<unsigned int>(document_id) % shards_.size();
+    }
+
+    SearchServer::PreparedQuery ShardedSearchServer::PrepareQuery(std::string_view raw_query) const {
+        // Shards share the stop words, so any of them splits the query alike
+        SearchServer::PreparedQuery query = shards_.front().PrepareQuery(raw_query);
+        const double document_count = GetDocumentCount();
+        std::vector<double> inverse_document_freqs;
+        for (const std::string& word : query.GetPlusWords()) {
+            int document_freq = 0;
+            for (const SearchServer& shard : shards_) {
+                document_freq += shard.GetDocumentFrequency(word);
+            }
+            inverse_document_freqs.push_back(document_freq == 0 ? 0.0 : std::log(document_count / document_freq));
+        }
+        query.SetInverseDocumentFreqs(std::move(inverse_document_freqs));
+        return query;
+    }
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "query_executor.h"
+#include "search_server.h"
+#include "top_documents.h"
+
+// Partitions documents by id over several SearchServer shards. Updates go to
+// the shard owning the id; queries run on every shard in parallel and the
+// per-shard top documents are merged. Plus words are scored with idfs
+// aggregated over all shards, so the ranking matches one server holding
+// every document.
+class ShardedSearchServer {
+public:
+    ShardedSearchServer(const std::string& stop_words, size_t shard_count);
+    template <typename Collection>
+    ShardedSearchServer(const Collection& stop_words, size_t shard_count);
+
+    void AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+    // Either all documents are added or, if any of them is invalid, none
+    void AddDocuments(const std::vector<SearchServer::BatchDocument>& documents);
+    void RemoveDocument(int document_id);
+    void Compact();
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status = DocumentStatus::ACTUAL, size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate, size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(std::string_view raw_query, int document_id) const;
+
+    int GetDocumentCount() const;
+    size_t GetShardCount() const;
+
+private:
+    std::vector<SearchServer> shards_;
+    mutable QueryExecutor executor_;
+
+    size_t GetShardIndex(int document_id) const;
+    SearchServer::PreparedQuery PrepareQuery(std::string_view raw_query) const;
+};
+
+template <typename Collection>
+ShardedSearchServer::ShardedSearchServer(const Collection& stop_words, size_t shard_count)
+{
+    if (shard_count == 0) {
+        throw std::invalid_argument("a sharded server needs at least one shard"s);
+    }
+    shards_.reserve(shard_count);
+    for (size_t shard = 0; shard < shard_count; ++shard) {
+        shards_.emplace_back(stop_words);
+    }
+}
+
+template <typename DocumentPredicate>
+std::vector<Document> ShardedSearchServer::FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate, size_t top_k) const {
+    const SearchServer::PreparedQuery query = PrepareQuery(raw_query);
+    std::vector<std::vector<Document>> shard_documents(shards_.size());
+    executor_.ParallelFor(shards_.size(),
+        [this, &query, &document_predicate, top_k, &shard_documents](size_t shard)
+        {
+            shard_documents[shard] = shards_[shard].FindTopDocuments(executor_, query, document_predicate, top_k);
+        });
+    TopDocuments top_documents(std::min(top_k, static_cast<size_t>(GetDocumentCount())));
+    for (const std::vector<Document>& documents : shard_documents) {
+        for (const Document& document : documents) {
+            top_documents.Push(document);
+        }
+    }
+    return top_documents.Extract();
+}
@@ -1,24 +1,143 @@
-#include <cassert>
-#include <iostream>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
 #include <string_view>
 #include <vector>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "string_processing.h"
 
+using std::string_literals::operator""s;
 
+namespace {
 
-std::vector<std::string_view> SplitIntoWords(std::string_view text) {
-    std::vector<std::string_view> result;
-    auto pos = text.find_first_not_of(" ");
-    const auto pos_end = text.npos;
-    text.remove_prefix(std::min((text.size()), pos));
+const size_t CHUNK_SIZE = 64;
+
+struct ChunkMasks {
+    uint64_t not_space;
+    bool has_control;
+};
+
+int CountTrailingZeros(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(mask);
+#else
+    int count = 0;
+    while ((mask & 1) == 0) {
+        mask >>= 1;
+        ++count;
+    }
+    return count;
+#endif
+}
 
-    while (!text.empty()) {
-        auto space = text.find(' ');
-        result.push_back(space == pos_end ? text.substr(0) : text.substr(0, space));
-        pos = text.find_first_not_of(" ", space);
-        text.remove_prefix(std::min(text.size(), pos));
+ChunkMasks ScanChunkScalar(const char* data, size_t size) {
+    ChunkMasks masks = { 0, false };
+    for (size_t i = 0; i < size; ++i) {
+        const unsigned char c = static_cast<unsigned char>(data[i]);
+        masks.not_space |= static_cast<uint64_t>(c != ' ') << i;
+        masks.has_control |= c < ' ';
     }
+    return masks;
+}
+
+// Bit i of not_space is set when byte i of the full 64-byte chunk is not a space
+ChunkMasks ScanChunk(const char* data) {
+#if defined(__AVX2__)
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i last_control = _mm256_set1_epi8(' ' - 1);
+    uint64_t spaces = 0;
+    uint64_t controls = 0;
+    for (size_t i = 0; i < CHUNK_SIZE; i += 32) {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        spaces |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, space)))) << i;
+        // unsigned byte <= 31 exactly when min(byte, 31) == byte
+        controls |= static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(bytes, last_control), bytes)));
+    }
+    return { ~spaces, controls != 0 };
+#elif defined(__SSE2__)
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i last_control = _mm_set1_epi8(' ' - 1);
+    uint64_t spaces = 0;
+    uint64_t controls = 0;
+    for (size_t i = 0; i < CHUNK_SIZE; i += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        spaces |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, space))) << i;
+        // unsigned byte <= 31 exactly when min(byte, 31) == byte
+        controls |= static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(bytes, last_control), bytes)));
+    }
+    return { ~spaces, controls != 0 };
+#else
+    return ScanChunkScalar(data, CHUNK_SIZE);
+#endif
+}
+
+class WordCollector {
+public:
+    explicit WordCollector(std::string_view text)
+        :text_(text)
+    {}
 
-    return result;
+    // Word boundaries are the bits where not_space differs from its
+    // value one byte earlier; they alternate between word start and end
+    void Collect(uint64_t not_space, size_t offset, size_t size) {
+        const uint64_t size_mask = size == CHUNK_SIZE ? ~uint64_t(0) : (uint64_t(1) << size) - 1;
+        not_space &= size_mask;
+        uint64_t boundaries = (not_space ^ ((not_space << 1) | (in_word_ ? 1 : 0))) & size_mask;
+        while (boundaries != 0) {
+            const size_t position = offset + CountTrailingZeros(boundaries);
+            if (in_word_) {
+                words_.push_back(text_.substr(word_begin_, position - word_begin_));
+            }
+            else {
+                word_begin_ = position;
+            }
+            in_word_ = !in_word_;
+            boundaries &= boundaries - 1;
+        }
+    }
+
+    std::vector<std::string_view> Finish() {
+        if (in_word_) {
+            words_.push_back(text_.substr(word_begin_));
+        }
+        return std::move(words_);
+    }
+
+private:
+    std::string_view text_;
+    std::vector<std::string_view> words_;
+    size_t word_begin_ = 0;
+    bool in_word_ = false;
+};
+
+void ThrowInvalidCharacters() {
+    throw std::invalid_argument("stop_words contains invalid characters"s);
+}
+
+} // namespace
+
+std::vector<std::string_view> SplitIntoWords(std::string_view text) {
+    WordCollector collector(text);
+    size_t offset = 0;
+    for (; offset + CHUNK_SIZE <= text.size(); offset += CHUNK_SIZE) {
+        const ChunkMasks masks = ScanChunk(text.data() + offset);
+        if (masks.has_control) {
+            ThrowInvalidCharacters();
+        }
+        collector.Collect(masks.not_space, offset, CHUNK_SIZE);
+    }
+    if (offset < text.size()) {
+        const ChunkMasks masks = ScanChunkScalar(text.data() + offset, text.size() - offset);
+        if (masks.has_control) {
+            ThrowInvalidCharacters();
+        }
+        collector.Collect(masks.not_space, offset, text.size() - offset);
+    }
+    return collector.Finish();
 }
@@ -1,6 +1,8 @@
 #pragma once
 
-std::vector<std::string_view> SplitIntoWords(std::string_view text);
-
-
+#include <string_view>
+#include <vector>
 
+// Splits text into space separated words and validates it in the same pass:
+// throws std::invalid_argument if the text contains control characters
+std::vector<std::string_view> SplitIntoWords(std::string_view text);
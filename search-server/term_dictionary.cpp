@@ -0,0 +1,56 @@
+#include "term_dictionary.h"
+
+TermDictionary::TermDictionary(const TermDictionary& other) {
+    terms_.reserve(other.terms_.size());
+    term_to_id_.reserve(other.terms_.size());
+    for (const std::string_view term : other.terms_) {
+        AddTerm(storage_.Store(term));
+    }
+}
+
+TermDictionary& TermDictionary::operator=(const TermDictionary& other) {
+    if (this != &other) {
+        *this = TermDictionary(other);
+    }
+    return *this;
+}
+
+TermId TermDictionary::Intern(std::string_view term) {
+    const auto it = term_to_id_.find(term);
+    if (it != term_to_id_.end()) {
+        return it->second;
+    }
+    return AddTerm(storage_.Store(term));
+}
+
+TermId TermDictionary::InternExternal(std::string_view term) {
+    const auto it = term_to_id_.find(term);
+    if (it != term_to_id_.end()) {
+        return it->second;
+    }
+    return AddTerm(term);
+}
+
+TermId TermDictionary::Find(std::string_view term) const {
+    const auto it = term_to_id_.find(term);
+    return it == term_to_id_.end() ? NO_TERM : it->second;
+}
+
+std::string_view TermDictionary::GetTerm(TermId term_id) const {
+    return terms_[term_id];
+}
+
+size_t TermDictionary::size() const {
+    return terms_.size();
+}
+
+size_t TermDictionary::GetTextBytes() const {
+    return storage_.GetAllocatedBytes();
+}
+
+TermId TermDictionary::AddTerm(std::string_view stored) {
+    const TermId term_id = static_cast<TermId>(terms_.size());
+    terms_.push_back(stored);
+    term_to_id_.emplace(stored, term_id);
+    return term_id;
+}
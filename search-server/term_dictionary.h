@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "text_arena.h"
+
+using TermId = uint32_t;
+
+// Maps every distinct word to a dense integer id. The dictionary owns
+// the text of its terms in an arena, so views returned by GetTerm stay
+// valid for the lifetime of the dictionary.
+class TermDictionary {
+public:
+    static constexpr TermId NO_TERM = UINT32_MAX;
+
+    TermDictionary() = default;
+    // A copy owns the text of all its terms, external ones included
+    TermDictionary(const TermDictionary& other);
+    TermDictionary& operator=(const TermDictionary& other);
+    TermDictionary(TermDictionary&&) = default;
+    TermDictionary& operator=(TermDictionary&&) = default;
+
+    TermId Intern(std::string_view term);
+    // Like Intern, but keeps a view of the caller's text instead of a copy;
+    // the text must outlive the dictionary
+    TermId InternExternal(std::string_view term);
+    TermId Find(std::string_view term) const;
+    std::string_view GetTerm(TermId term_id) const;
+
+    size_t size() const;
+    size_t GetTextBytes() const;
+
+private:
+    TextArena storage_;
+    std::vector<std::string_view> terms_;
+    std::unordered_map<std::string_view, TermId> term_to_id_;
+
+    TermId AddTerm(std::string_view stored);
+};
@@ -0,0 +1,38 @@
+#include <cstring>
+
+#include "text_arena.h"
+
+std::string_view TextArena::Store(std::string_view text) {
+    if (text.empty()) {
+        return {};
+    }
+    // Oversized text gets a chunk of its own so the current one keeps its tail
+    if (text.size() > CHUNK_SIZE / 4) {
+        chunks_.push_back(std::make_unique<char[]>(text.size()));
+        allocated_bytes_ += text.size();
+        std::memcpy(chunks_.back().get(), text.data(), text.size());
+        return { chunks_.back().get(), text.size() };
+    }
+    if (text.size() > available_) {
+        chunks_.push_back(std::make_unique<char[]>(CHUNK_SIZE));
+        allocated_bytes_ += CHUNK_SIZE;
+        position_ = chunks_.back().get();
+        available_ = CHUNK_SIZE;
+    }
+    std::memcpy(position_, text.data(), text.size());
+    const std::string_view stored(position_, text.size());
+    position_ += text.size();
+    available_ -= text.size();
+    return stored;
+}
+
+void TextArena::Clear() {
+    chunks_.clear();
+    allocated_bytes_ = 0;
+    position_ = nullptr;
+    available_ = 0;
+}
+
+size_t TextArena::GetAllocatedBytes() const {
+    return allocated_bytes_;
+}
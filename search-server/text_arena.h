@@ -0,0 +1,24 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Append-only text storage carved out of large chunks. Stored views stay
+// valid until the arena is cleared or destroyed; memory is only released
+// in bulk.
+class TextArena {
+public:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    std::string_view Store(std::string_view text);
+    void Clear();
+
+    size_t GetAllocatedBytes() const;
+
+private:
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    size_t allocated_bytes_ = 0;
+    char* position_ = nullptr;
+    size_t available_ = 0;
+};
@@ -0,0 +1,45 @@
+#include <algorithm>
+#include <cmath>
+
+#include "top_documents.h"
+
+bool IsMoreRelevant(const Document& lhs, const Document& rhs) {
+    const double EPSILON = 1e-6;
+    if (std::abs(lhs.relevance - rhs.relevance) < EPSILON) {
+        return lhs.rating > rhs.rating;
+    }
+    return lhs.relevance > rhs.relevance;
+}
+
+TopDocuments::TopDocuments(size_t capacity)
+    :capacity_(capacity)
+{
+    heap_.reserve(capacity);
+}
+
+void TopDocuments::Push(const Document& document) {
+    if (heap_.size() < capacity_) {
+        heap_.push_back(document);
+        std::push_heap(heap_.begin(), heap_.end(), IsMoreRelevant);
+        return;
+    }
+    if (capacity_ == 0 || !IsMoreRelevant(document, heap_.front())) {
+        return;
+    }
+    std::pop_heap(heap_.begin(), heap_.end(), IsMoreRelevant);
+    heap_.back() = document;
+    std::push_heap(heap_.begin(), heap_.end(), IsMoreRelevant);
+}
+
+bool TopDocuments::IsFull() const {
+    return heap_.size() == capacity_;
+}
+
+const Document& TopDocuments::GetWorst() const {
+    return heap_.front();
+}
+
+std::vector<Document> TopDocuments::Extract() {
+    std::sort_heap(heap_.begin(), heap_.end(), IsMoreRelevant);
+    return std::move(heap_);
+}
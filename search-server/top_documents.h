@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+
+#include "document.h"
+
+// Ranking order of search results: higher relevance first, documents with
+// equal relevance are ordered by rating
+bool IsMoreRelevant(const Document& lhs, const Document& rhs);
+
+// Keeps the best `capacity` documents pushed into it. The worst kept
+// document sits on top of a heap, so every push costs O(log capacity).
+class TopDocuments {
+public:
+    explicit TopDocuments(size_t capacity);
+
+    void Push(const Document& document);
+
+    bool IsFull() const;
+    const Document& GetWorst() const;
+
+    std::vector<Document> Extract();
+
+private:
+    size_t capacity_;
+    std::vector<Document> heap_;
+};